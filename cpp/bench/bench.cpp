@@ -0,0 +1,311 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/graph.h"
+
+namespace {
+
+std::atomic<long long> allocations(0);
+
+}
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if(void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+/**
+ * Each measurement runs batches until this much time was measured.
+ */
+const double MIN_SECONDS = 0.05;
+
+/**
+ * Accumulates time and allocations between start() and stop().
+ */
+class Stopwatch {
+public:
+    void start() {
+        allocationsAtStart = allocations.load(std::memory_order_relaxed);
+        startTime = std::chrono::steady_clock::now();
+    }
+    void stop() {
+        elapsed += std::chrono::steady_clock::now() - startTime;
+        numAllocations += allocations.load(std::memory_order_relaxed) - allocationsAtStart;
+    }
+    double seconds() const { return elapsed.count(); }
+    long long allocationCount() const { return numAllocations; }
+private:
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::duration<double> elapsed{0};
+    long long allocationsAtStart = 0;
+    long long numAllocations = 0;
+};
+
+struct Family {
+    std::string name;
+    std::vector<int> sizes;
+    std::function<AdjList(int)> generate;
+};
+
+void link(AdjList& a, const int v1, const int v2) {
+    a[v1].emplace_back(v1, v2);
+    a[v2].emplace_back(v2, v1);
+}
+
+AdjList path(const int n) {
+    AdjList a;
+    for(int v = 0; v + 1 < n; v++) {
+        link(a, v, v + 1);
+    }
+    return a;
+}
+
+AdjList cycle(const int n) {
+    AdjList a = path(n);
+    link(a, n - 1, 0);
+    return a;
+}
+
+AdjList tree(const int n) {
+    std::mt19937 rng(n);
+    AdjList a;
+    for(int v = 1; v < n; v++) {
+        link(a, std::uniform_int_distribution<int>(0, v - 1)(rng), v);
+    }
+    return a;
+}
+
+AdjList complete(const int n) {
+    AdjList a;
+    for(int v1 = 0; v1 < n; v1++) {
+        for(int v2 = v1 + 1; v2 < n; v2++) {
+            link(a, v1, v2);
+        }
+    }
+    return a;
+}
+
+/**
+ * Random bipartite graph B_m_n with m = n = size / 2 and average degree about 4.
+ */
+AdjList bipartite(const int size) {
+    std::mt19937 rng(size);
+    const int half = size / 2;
+    std::uniform_int_distribution<int> pick(0, half - 1);
+    std::vector<std::vector<char> > used(half, std::vector<char>(half, 0));
+    AdjList a;
+    for(int i = 0; i < 2 * size; i++) {
+        const int left = pick(rng), right = pick(rng);
+        if(!used[left][right]) {
+            used[left][right] = 1;
+            link(a, left, half + right);
+        }
+    }
+    return a;
+}
+
+/**
+ * List of all edges as vertex pairs.
+ */
+std::vector<std::pair<int, int> > edgesOf(Graph& g) {
+    std::vector<std::pair<int, int> > edges;
+    for(const auto& kv : g.getAdj()) {
+        for(const auto& e : kv.second) {
+            if(e.v1 < e.v2) {
+                edges.emplace_back(e.v1, e.v2);
+            }
+        }
+    }
+    return edges;
+}
+
+/**
+ * Graph with artificial constraints on every vertex, so that color queries
+ * have something to look at. Every third vertex gets a gap.
+ */
+Graph constrained(const AdjList& a) {
+    AdjList copy = a;
+    Graph g(copy);
+    for(const auto& kv : a) {
+        const int v = kv.first;
+        g.addVertexConstraint(v, v % 5 + 2);
+        g.addVertexConstraint(v, v % 5 + (v % 3 == 0 ? 4 : 3));
+    }
+    return g;
+}
+
+/**
+ * Run batch until MIN_SECONDS were measured and print ns/op and allocations/op.
+ * Batch starts and stops the stopwatch around measured part and returns number of ops.
+ */
+void run(const std::string& family, const int size, const std::string& op,
+    const std::string& filter, const std::function<long long(Stopwatch&)>& batch) {
+
+    const std::string name = family + "/" + op;
+    if(name.find(filter) == std::string::npos) {
+        return;
+    }
+    Stopwatch stopwatch;
+    long long ops = 0;
+    while(stopwatch.seconds() < MIN_SECONDS) {
+        const long long done = batch(stopwatch);
+        if(done == 0) {
+            return;
+        }
+        ops += done;
+    }
+    std::printf("%-12s %6d  %-24s %14.1f %12.2f\n", family.c_str(), size, op.c_str(),
+        stopwatch.seconds() * 1e9 / ops, (double)stopwatch.allocationCount() / ops);
+}
+
+void benchFamily(const Family& family, const int size, const std::string& filter) {
+    const AdjList adj = family.generate(size);
+    const Graph base = constrained(adj);
+    Graph query = base;
+    const auto edges = edgesOf(query);
+    std::vector<int> vertices;
+    for(const auto& kv : adj) {
+        vertices.emplace_back(kv.first);
+    }
+    const auto forVertices = [&](const std::function<void(int)>& f) {
+        return [&, f](Stopwatch& stopwatch) -> long long {
+            stopwatch.start();
+            for(const int v : vertices) {
+                f(v);
+            }
+            stopwatch.stop();
+            return vertices.size();
+        };
+    };
+    const auto& name = family.name;
+
+    run(name, size, "legalColoringsOf", filter, forVertices([&](const int v) {
+        query.legalColoringsOf(v);
+    }));
+    run(name, size, "legalColoringsOfEdge", filter, [&](Stopwatch& stopwatch) -> long long {
+        stopwatch.start();
+        for(const auto& e : edges) {
+            query.legalColoringsOfEdge(e.first, e.second);
+        }
+        stopwatch.stop();
+        return edges.size();
+    });
+    run(name, size, "areGaps", filter, forVertices([&](const int v) {
+        query.areGaps(v);
+    }));
+    run(name, size, "findCycle", filter, [&](Stopwatch& stopwatch) -> long long {
+        stopwatch.start();
+        query.findCycle();
+        stopwatch.stop();
+        return 1;
+    });
+    run(name, size, "findPath", filter, [&](Stopwatch& stopwatch) -> long long {
+        stopwatch.start();
+        query.findPath();
+        stopwatch.stop();
+        return 1;
+    });
+    run(name, size, "moveEdgeToAnotherGraph", filter, [&](Stopwatch& stopwatch) -> long long {
+        Graph g = base;
+        AdjList empty;
+        Graph other(empty);
+        stopwatch.start();
+        for(const auto& e : edges) {
+            g.moveEdgeToAnotherGraph(other, e.first, e.second);
+        }
+        stopwatch.stop();
+        return edges.size();
+    });
+    run(name, size, "moveHangingEdgesTo", filter, [&](Stopwatch& stopwatch) -> long long {
+        Graph g = base;
+        AdjList empty;
+        Graph other(empty);
+        stopwatch.start();
+        g.moveHangingEdgesTo(other);
+        stopwatch.stop();
+        return 1;
+    });
+
+    // colorPath and colorPathDP on a cycle of the graph or, in forests, on a path
+    std::vector<int> route = query.findCycle();
+    if(route.empty()) {
+        route = query.findPath();
+    }
+    if(route.size() > 1) {
+        run(name, size, "colorPath", filter, [&](Stopwatch& stopwatch) -> long long {
+            AdjList copy = adj;
+            Graph g(copy);
+            const auto routeEdges = g.pathEdges(route);
+            stopwatch.start();
+            g.colorPath(routeEdges);
+            stopwatch.stop();
+            return 1;
+        });
+        run(name, size, "colorPathDP", filter, [&](Stopwatch& stopwatch) -> long long {
+            AdjList copy = adj;
+            Graph g(copy);
+            const auto routeEdges = g.pathEdges(route);
+            stopwatch.start();
+            g.colorPathDP(routeEdges);
+            stopwatch.stop();
+            return 1;
+        });
+    }
+}
+
+}
+
+/**
+ * Measures primitive operations of the solver on generated graph families.
+ * Optional argument selects operations whose "family/operation" name contains it.
+ */
+int main(int argc, char *argv[]) {
+    const std::string filter = argc >= 2 ? argv[1] : "";
+
+    const std::vector<int> sparseSizes{64, 512, 4096};
+    const std::vector<Family> families{
+        {"path", sparseSizes, path},
+        {"cycle", sparseSizes, cycle},
+        {"tree", sparseSizes, tree},
+        {"K_n", {8, 16, 32}, complete},
+        {"B_m_n", sparseSizes, bipartite},
+    };
+
+    std::printf("%-12s %6s  %-24s %14s %12s\n", "family", "size", "operation", "ns/op",
+        "allocs/op");
+    for(const auto& family : families) {
+        for(const int size : family.sizes) {
+            benchFamily(family, size, filter);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/graph_loader.h"
+
+namespace {
+
+/**
+ * Parser used by Graph::deserialize before the memory-mapped loader.
+ */
+void parseWithStreams(const std::string& fileName, AdjacencyRows& rows) {
+    std::ifstream file(fileName);
+    std::string line;
+    while (getline(file, line)) {
+        std::istringstream iss(line);
+        int vertex, neighbour;
+
+        if(!(iss >> vertex)) {
+            continue;
+        }
+        rows.rowIds.emplace_back(vertex);
+        while (iss >> neighbour) {
+            rows.neighbourIds.emplace_back(neighbour);
+        }
+        rows.rowOffsets.emplace_back(rows.neighbourIds.size());
+    }
+}
+
+/**
+ * Write random symmetric graph with given number of vertices and average degree.
+ */
+void generateInput(const std::string& fileName, const int numVertices, const int degree) {
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> pick(0, numVertices - 1);
+    std::vector<std::vector<int> > adj(numVertices);
+    for(long long i = 0; i < (long long)numVertices * degree / 2; i++) {
+        const int a = pick(rng), b = pick(rng);
+        if(a != b) {
+            adj[a].emplace_back(b);
+            adj[b].emplace_back(a);
+        }
+    }
+    std::ofstream out(fileName);
+    for(int v = 0; v < numVertices; v++) {
+        out << v;
+        for(const int n : adj[v]) {
+            out << ' ' << n;
+        }
+        out << '\n';
+    }
+}
+
+template<typename F>
+double bestSeconds(const int repeats, F f) {
+    double best = 1e100;
+    for(int i = 0; i < repeats; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+}
+
+/**
+ * Measures load throughput of the adjacency list parsers in MB/s.
+ */
+int main(int argc, char *argv[]) {
+    std::string fileName;
+    bool generated = false;
+    if(argc >= 2) {
+        fileName = argv[1];
+    } else {
+        fileName = "gcolor_load_bench.txt";
+        std::cout << "Generating input " << fileName << std::endl;
+        generateInput(fileName, 1000000, 16);
+        generated = true;
+    }
+
+    MappedFile probe(fileName);
+    if(!probe.isOpen()) {
+        std::cout << "Cannot read " << fileName << std::endl;
+        return 1;
+    }
+    const double megabytes = probe.size() / (1024.0 * 1024.0);
+    std::cout << "Input: " << fileName << " (" << megabytes << " MB)" << std::endl;
+
+    const int repeats = 3;
+    size_t expectedNeighbours = 0;
+    const double streams = bestSeconds(repeats, [&]() {
+        AdjacencyRows rows;
+        parseWithStreams(fileName, rows);
+        expectedNeighbours = rows.neighbourIds.size();
+    });
+    std::cout << "getline + istringstream: " << megabytes / streams << " MB/s" << std::endl;
+
+    const unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for(unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        bool same = true;
+        const double seconds = bestSeconds(repeats, [&]() {
+            AdjacencyRows rows;
+            loadAdjacencyRows(fileName, rows, threads);
+            same = rows.neighbourIds.size() == expectedNeighbours;
+        });
+        std::cout << "mmap, " << threads << " thread(s): " << megabytes / seconds << " MB/s"
+                  << (same ? "" : " (MISMATCH)") << std::endl;
+    }
+
+    if(generated) {
+        std::remove(fileName.c_str());
+    }
+    return 0;
+}
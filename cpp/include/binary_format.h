@@ -0,0 +1,112 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef BINARY_FORMAT_H
+#define BINARY_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "csr_graph.h"
+#include "graph_loader.h"
+
+/**
+ * Current version of binary graph format.
+ */
+const uint32_t BINARY_GRAPH_VERSION = 1;
+
+/**
+ * Flag of binary graph header: vertex ids are strictly increasing and so are
+ * (smaller, larger) endpoint pairs of edges, which is checked in one pass.
+ */
+const uint32_t BINARY_GRAPH_SORTED = 1;
+
+/**
+ * Header of binary graph file (.gcb). Sections follow it in this order,
+ * each starting at a multiple of 8 bytes:
+ *   int32  vertexIds[numVertices]
+ *   uint64 offsets[numVertices + 1]   slot range of every vertex
+ *   int32  neighbours[2 * numEdges]   dense index of neighbour in every slot
+ *   int32  slotEdges[2 * numEdges]    edge in every slot
+ *   int32  edgeEnds[2 * numEdges]     dense endpoints of every edge
+ *   int32  colors[numEdges]           0 means no color, never negative
+ * Integers are stored in little endian byte order. Flags are
+ * BINARY_GRAPH_SORTED or 0, files without it are sorted to be checked.
+ */
+struct BinaryGraphHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t numVertices;
+    uint64_t numEdges;
+};
+
+/**
+ * Check if buffer starts with binary graph magic.
+ */
+bool isBinaryGraph(const char* data, const size_t size);
+
+/**
+ * Read-only view of a binary graph, used directly from the file mapping.
+ */
+class BinaryGraphView {
+public:
+    /**
+     * Map and validate given file.
+     */
+    explicit BinaryGraphView(const std::string& fileName);
+    /**
+     * Validate binary graph in a buffer owned by the caller. On big endian
+     * hosts the view keeps a byte swapped copy instead.
+     */
+    BinaryGraphView(const char* data, const size_t size);
+
+    /**
+     * Return true if data is a complete binary graph of a supported version.
+     */
+    bool isValid() const { return valid; }
+
+    uint64_t numVertices() const { return header->numVertices; }
+    uint64_t numEdges() const { return header->numEdges; }
+    const int32_t* vertexIds() const { return ids; }
+    const uint64_t* offsets() const { return slotOffsets; }
+    const int32_t* neighbours() const { return slotNeighbours; }
+    const int32_t* slotEdges() const { return edges; }
+    const int32_t* edgeEnds() const { return ends; }
+    const int32_t* colors() const { return edgeColors; }
+private:
+    void validate(const char* data, const size_t size);
+    /**
+     * Check that no vertex id and no endpoint pair repeats.
+     */
+    bool isSimple() const;
+
+    std::unique_ptr<MappedFile> file;
+    std::vector<char> swapped;
+    const BinaryGraphHeader* header = nullptr;
+    const int32_t* ids = nullptr;
+    const uint64_t* slotOffsets = nullptr;
+    const int32_t* slotNeighbours = nullptr;
+    const int32_t* edges = nullptr;
+    const int32_t* ends = nullptr;
+    const int32_t* edgeColors = nullptr;
+    bool valid = false;
+};
+
+/**
+ * Write present vertices and live edges of graph in binary format, vertices
+ * ordered by id and edges by endpoints. Return false if file cannot be written.
+ */
+bool writeBinaryGraph(const CsrGraph& graph, const std::string& fileName);
+
+/**
+ * Fill graph with vertices and edges of a valid view. Edges are left
+ * uncolored, colors() are applied by the caller.
+ */
+void readBinaryGraph(const BinaryGraphView& view, CsrGraph& graph);
+#endif //BINARY_FORMAT_H
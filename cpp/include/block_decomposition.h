@@ -0,0 +1,55 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef BLOCK_DECOMPOSITION_H
+#define BLOCK_DECOMPOSITION_H
+
+#include <cstddef>
+#include <vector>
+
+#include "csr_graph.h"
+
+/**
+ * Biconnected blocks of a graph and its cut vertices (Hopcroft-Tarjan).
+ *
+ * Every edge belongs to exactly one block; bridges are blocks with a single
+ * edge. Vertices in more than one block are cut vertices, and blocks joined
+ * by cut vertices form a forest, the block-cut tree. The depth-first search
+ * runs on an explicit stack in O(V + E).
+ */
+class BlockDecomposition {
+public:
+    void build(const CsrGraph& graph);
+    int numBlocks() const { return (int)blockOffsets.size() - 1; }
+    /**
+     * Edges of block b.
+     */
+    const int* blockBegin(const int b) const { return blockEdges.data() + blockOffsets[b]; }
+    const int* blockEnd(const int b) const { return blockEdges.data() + blockOffsets[b+1]; }
+    bool isCutVertex(const int v) const { return cut[v]; }
+private:
+    struct Frame {
+        int v;
+        int parentEdge;
+    };
+
+    void search(const CsrGraph& graph, const int root);
+
+    /**
+     * Edges of block b are blockEdges[blockOffsets[b]] .. blockEdges[blockOffsets[b+1]-1].
+     */
+    std::vector<int> blockEdges;
+    std::vector<size_t> blockOffsets{0};
+    std::vector<char> cut;
+
+    // search state, kept between builds to reuse memory
+    std::vector<Frame> stack;
+    std::vector<int> edgeStack;
+    std::vector<int> nextSlot;
+    std::vector<int> discovered;
+    std::vector<int> low;
+    int time = 0;
+};
+#endif //BLOCK_DECOMPOSITION_H
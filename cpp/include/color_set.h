@@ -0,0 +1,80 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef COLOR_SET_H
+#define COLOR_SET_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Set of positive colors, stored as a 128-bit occupancy mask over a window
+ * starting at the lowest color. Colors spanning more than the window are
+ * kept in a sorted vector instead. Constraints of a vertex are usually a few
+ * neighbouring colors, so they fit the window and queries are bit operations.
+ */
+class ColorSet {
+public:
+    static const int WINDOW = 128;
+
+    /**
+     * Add color. Return true if it was not in the set.
+     */
+    bool insert(const int color);
+    bool contains(const int color) const;
+    bool empty() const { return numColors == 0; }
+    int size() const { return numColors; }
+    /**
+     * Lowest and highest color, -1 if set is empty.
+     */
+    int lowest() const;
+    int highest() const;
+    /**
+     * Smallest color in set that is at least given color, -1 if there is none.
+     */
+    int next(const int color) const;
+    /**
+     * Lowest color missing between lowest() and highest(), -1 if there are no gaps.
+     */
+    int firstGap() const;
+    bool hasGaps() const { return numColors > 0 && highest() - lowest() + 1 > numColors; }
+    /**
+     * Call f for every color in ascending order.
+     */
+    template<typename F>
+    void forEach(F f) const;
+    std::vector<int> toVector() const;
+private:
+    bool isWide() const { return !wide.empty(); }
+    /**
+     * Move window so that it starts at newBase; colors must stay inside.
+     */
+    void rebase(const int newBase);
+    void spill();
+
+    int base = 0;
+    int numColors = 0;
+    uint64_t bits[2] = {0, 0};
+    /**
+     * Sorted colors when they do not fit the window; bits are unused then.
+     */
+    std::vector<int> wide;
+};
+
+template<typename F>
+void ColorSet::forEach(F f) const {
+    if(isWide()) {
+        for(const int c : wide) {
+            f(c);
+        }
+        return;
+    }
+    for(int w = 0; w < 2; w++) {
+        for(uint64_t word = bits[w]; word != 0; word &= word - 1) {
+            f(base + 64 * w + __builtin_ctzll(word));
+        }
+    }
+}
+#endif //COLOR_SET_H
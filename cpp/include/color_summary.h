@@ -0,0 +1,39 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef COLOR_SUMMARY_H
+#define COLOR_SUMMARY_H
+
+/**
+ * Summary of all colors seen at a vertex (colors of its edges plus its constraints).
+ * Kept up to date by the graph on every color and constraint change.
+ */
+struct ColorSummary {
+    /**
+     * Lowest and highest color, -1 if there are no colors.
+     */
+    int lowest = -1;
+    int highest = -1;
+    /**
+     * Number of distinct colors.
+     */
+    int distinct = 0;
+    /**
+     * Number of colors used by more than one edge.
+     */
+    int duplicates = 0;
+    /**
+     * Set when lowest or highest color was removed and has to be recomputed.
+     */
+    bool stale = false;
+
+    bool empty() const { return distinct == 0; }
+
+    /**
+     * Check if distinct colors do not form an interval.
+     */
+    bool hasGaps() const { return distinct > 0 && highest - lowest + 1 > distinct; }
+};
+#endif //COLOR_SUMMARY_H
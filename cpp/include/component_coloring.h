@@ -0,0 +1,30 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef COMPONENT_COLORING_H
+#define COMPONENT_COLORING_H
+
+#include "graph.h"
+#include "solver_stats.h"
+#include "solver_config.h"
+
+/**
+ * Color every connected component of graph as a separate graph on a pool of
+ * numThreads workers (0 means one per hardware thread, 1 colors them on the
+ * calling thread), largest first.
+ * Uncolored components are further split into biconnected blocks, which are
+ * colored independently and joined by shifting their palettes at cut
+ * vertices; if a block cannot be colored alone, its component is colored
+ * as a whole.
+ *
+ * Colored edges are moved to outGraph, edges the solver could not color stay
+ * in graph. Return true if every component was colored. If stats is not null,
+ * it receives sum of the stats of all colored graphs, except totalTime which
+ * is the wall time of the whole call. Each colored graph gets its own copy of
+ * config (see SolverConfig), with a seed derived from config's seed.
+ */
+bool colorComponents(Graph& graph, Graph& outGraph, unsigned numThreads,
+    SolverStats* stats = nullptr, const SolverConfig* config = nullptr);
+#endif //COMPONENT_COLORING_H
@@ -0,0 +1,196 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "edge.h"
+#include "pair_table.h"
+
+/**
+ * Compressed sparse row graph core.
+ *
+ * Vertices are addressed by dense indices, edges by ids. Every vertex owns
+ * a contiguous block of slots in one neighbour array; each slot refers to
+ * the neighbour and to the undirected edge. Each undirected edge has exactly
+ * one Edge record (with original vertex ids) and thus a single color.
+ * Blocks have some slack so edges can be added and removed in O(1);
+ * a block that overflows is moved to the end of the array.
+ */
+class CsrGraph {
+public:
+    /**
+     * Return dense index of vertex with given id, adding it if needed.
+     * Added vertex is marked as present.
+     */
+    int addVertex(const int id);
+    /**
+     * Return dense index of vertex with given id, allocating it if needed,
+     * without marking it as present.
+     */
+    int internVertex(const int id);
+    /**
+     * Return dense index of vertex with given id or -1 if it was never added.
+     */
+    int indexOf(const int id) const;
+    /**
+     * Return original id of dense vertex.
+     */
+    int idOf(const int v) const { return ids[v]; }
+    /**
+     * Check if dense vertex is part of the graph (has edges or was added explicitly).
+     */
+    bool isPresent(const int v) const { return present[v]; }
+    /**
+     * Add undirected edge between dense vertices. Return its id.
+     * If edge already exists, its id is returned and nothing changes.
+     */
+    int addEdge(const int a, const int b, const int color = 0);
+    /**
+     * Remove edge. Endpoints left without edges are no longer present.
+     */
+    void removeEdge(const int e);
+    /**
+     * Park edge: hide it from adjacency and from findEdge but keep its id,
+     * endpoints and record, so that restoreEdge puts it back in O(1).
+     * Endpoints left without edges are no longer present.
+     */
+    void parkEdge(const int e);
+    /**
+     * Put parked edge back. Its endpoints must not have got another edge meanwhile.
+     */
+    void restoreEdge(const int e);
+    bool isParked(const int e) const { return parked[e]; }
+    /**
+     * Remove all vertices and edges.
+     */
+    void clear();
+    /**
+     * Return id of edge between dense vertices a and b or -1.
+     */
+    int findEdge(const int a, const int b) const { return index.find(std::min(a, b), std::max(a, b)); }
+    /**
+     * Check if edge id refers to an edge in graph that is not parked.
+     */
+    bool isEdge(const int e) const {
+        return e >= 0 && e < (int)edgeEnds.size() && edgeEnds[e].first >= 0 && !parked[e];
+    }
+
+    int degree(const int v) const { return blocks[v].degree; }
+    /**
+     * Neighbour in i-th slot of dense vertex v.
+     */
+    int neighbour(const int v, const int i) const { return slotNeighbour[blocks[v].start + i]; }
+    /**
+     * Edge in i-th slot of dense vertex v.
+     */
+    int edgeAt(const int v, const int i) const { return slotEdge[blocks[v].start + i]; }
+
+    /**
+     * Return record of edge. Its orientation (v1, v2) is arbitrary.
+     */
+    Edge& edge(const int e) { return records[e]; }
+    const Edge& edge(const int e) const { return records[e]; }
+    /**
+     * Return dense endpoints of edge.
+     */
+    const std::pair<int, int>& endpoints(const int e) const { return edgeEnds[e]; }
+    /**
+     * Return other endpoint of edge.
+     */
+    int other(const int e, const int v) const {
+        return edgeEnds[e].first == v ? edgeEnds[e].second : edgeEnds[e].first;
+    }
+
+    /**
+     * Number of dense vertex indices ever allocated (present or not).
+     */
+    int vertexCapacity() const { return (int)ids.size(); }
+    /**
+     * Number of edge ids ever allocated (live or not).
+     */
+    int edgeCapacity() const { return (int)edgeEnds.size(); }
+    int numVertices() const { return numPresent; }
+    int numEdges() const { return numLive; }
+    bool empty() const { return numPresent == 0; }
+
+    /**
+     * Build graph from adjacency rows in one pass.
+     * rowOffsets has rowIds.size()+1 entries delimiting each row in neighbourIds.
+     * Order of neighbours in each vertex block follows its own row; edges
+     * listed only in one row are appended to the other endpoint's block.
+     */
+    void build(const std::vector<int>& rowIds, const std::vector<size_t>& rowOffsets,
+        const std::vector<int>& neighbourIds);
+    /**
+     * Replace graph with ready CSR arrays of n vertices and m edges, all present.
+     * Slots of vertex v are offsets[v] .. offsets[v+1]-1; edge e joins dense
+     * vertices ends[2e] and ends[2e+1]. Arrays must describe a simple graph
+     * with every edge in the blocks of both its endpoints.
+     */
+    void assign(const int n, const int32_t* vertexIds, const uint64_t* offsets,
+        const int32_t* neighbours, const int32_t* slotEdges, const int m, const int32_t* ends);
+private:
+    struct Block {
+        int start;
+        int degree;
+        int capacity;
+    };
+
+    void ensureSlot(const int v);
+    void compact();
+    /**
+     * Append edge to blocks of both endpoints.
+     */
+    void linkSlots(const int e);
+    /**
+     * Swap-remove edge from blocks of both endpoints.
+     */
+    void unlinkSlots(const int e);
+    int slotOf(const int e, const int v) const {
+        return edgeEnds[e].first == v ? edgeSlots[e].first : edgeSlots[e].second;
+    }
+    void setSlotOf(const int e, const int v, const int slot) {
+        if(edgeEnds[e].first == v) {
+            edgeSlots[e].first = slot;
+        } else {
+            edgeSlots[e].second = slot;
+        }
+    }
+
+    /**
+     * Ids below this bound are mapped through a flat table, others through a hash map.
+     */
+    static const int DIRECT_ID_LIMIT = 1 << 22;
+
+    std::vector<int> ids;
+    std::vector<int> directIndex;
+    std::unordered_map<int, int> sparseIndex;
+    std::vector<char> present;
+    std::vector<Block> blocks;
+
+    std::vector<int> slotNeighbour;
+    std::vector<int> slotEdge;
+    size_t deadSlots = 0;
+
+    std::vector<std::pair<int, int> > edgeEnds;
+    std::vector<std::pair<int, int> > edgeSlots;
+    std::vector<Edge> records;
+    std::vector<char> parked;
+    /**
+     * Maps (min, max) pair of dense endpoints to edge id.
+     */
+    PairTable index;
+
+    int numPresent = 0;
+    int numLive = 0;
+};
+#endif //CSR_GRAPH_H
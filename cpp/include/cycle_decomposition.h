@@ -0,0 +1,115 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef CYCLE_DECOMPOSITION_H
+#define CYCLE_DECOMPOSITION_H
+
+#include <cstddef>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "csr_graph.h"
+
+/**
+ * Edge-disjoint cycles of a graph found in a single depth-first pass.
+ *
+ * Whenever the search meets an edge back to a vertex on its stack, the
+ * cycle closed by it is recorded, its edges are marked as used and the
+ * vertices above the closing vertex are released so that they can be
+ * entered again through their remaining edges. Every slot is scanned once,
+ * so building takes O(V + E); edges left unused form a forest.
+ *
+ * Cycles are handed out in the order they were found, or by priority after
+ * prioritize. A cycle is skipped if any of its edges was removed from the
+ * graph in the meantime; the owner rebuilds the decomposition after edges
+ * are added.
+ */
+class CycleDecomposition {
+public:
+    /**
+     * Decompose graph, starting the search at dense vertex start.
+     */
+    void build(const CsrGraph& graph, const int start);
+    /**
+     * Store next cycle whose edges are all still in graph as dense vertices,
+     * first vertex repeated at the end. Return false if no cycle is left.
+     */
+    bool next(const CsrGraph& graph, std::vector<int>& vertices);
+    /**
+     * Hand out cycles of last build by priority from now on: the cycle with
+     * the largest mean score of its dense vertices first, ties in the order
+     * found, or in an order drawn from rng if it is not null.
+     */
+    void prioritize(const std::function<long long(int)>& score, std::mt19937* rng = nullptr);
+    /**
+     * Queue cycles through given dense vertices again with their current
+     * scores, after scores of these vertices changed. Takes O(k log k) for
+     * k affected cycle vertices.
+     */
+    void reprioritize(const std::vector<int>& vertices, const std::function<long long(int)>& score);
+    /**
+     * Number of cycles found by last build.
+     */
+    int numCycles() const { return (int)cycleOffsets.size() - 1; }
+private:
+    struct Frame {
+        int v;
+        int parentEdge;
+    };
+    /**
+     * Queued cycle. Entries older than version of their cycle are stale.
+     */
+    struct Entry {
+        long long priority;
+        unsigned tie;
+        int cycle;
+        unsigned version;
+        bool operator<(const Entry& other) const {
+            return priority < other.priority || (priority == other.priority && tie > other.tie);
+        }
+    };
+
+    void search(const CsrGraph& graph, const int root);
+    void emitCycle(const int from, const int closingEdge);
+    void enqueue(const int cycle, const std::function<long long(int)>& score);
+    /**
+     * Return false if some edge of cycle is gone from graph.
+     */
+    bool isIntact(const CsrGraph& graph, const int cycle) const;
+
+    /**
+     * Vertices of cycle c are cycleVertices[cycleOffsets[c]] .. cycleVertices[cycleOffsets[c+1]-1],
+     * its edges are at the same positions in cycleEdges (edge i joins vertex i with i+1).
+     */
+    std::vector<int> cycleVertices;
+    std::vector<int> cycleEdges;
+    std::vector<size_t> cycleOffsets{0};
+    size_t nextCycle = 0;
+
+    bool prioritized = false;
+    std::priority_queue<Entry> queue;
+    std::vector<unsigned> versions;
+    /**
+     * Rank of every cycle among cycles of equal priority.
+     */
+    std::vector<unsigned> ties;
+    std::vector<char> handedOut;
+    /**
+     * Cycles through dense vertex v are cyclesOf[cyclesOfOffsets[v]] .. cyclesOf[cyclesOfOffsets[v+1]-1].
+     */
+    std::vector<int> cyclesOf;
+    std::vector<size_t> cyclesOfOffsets;
+
+    // search state, kept between builds to reuse memory
+    std::vector<Frame> stack;
+    std::vector<int> nextSlot;
+    std::vector<int> stackPos;
+    std::vector<char> visited;
+    std::vector<char> used;
+    std::vector<int> roots;
+};
+#endif //CYCLE_DECOMPOSITION_H
@@ -15,5 +15,10 @@ struct Edge {
     int color;
 
     Edge(int v1, int v2, int color = 0) : v1(v1), v2(v2), color(color) {}
+
+    /**
+     * Lets an Edge snapshot returned by EdgeHandle be used like a pointer.
+     */
+    const Edge* operator->() const { return this; }
 };
 #endif //EDGE_H
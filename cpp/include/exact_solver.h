@@ -0,0 +1,72 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef EXACT_SOLVER_H
+#define EXACT_SOLVER_H
+
+#include <atomic>
+
+#include "graph.h"
+#include "solver_stats.h"
+
+/**
+ * Outcome of exact search.
+ */
+enum class ExactResult {
+    /**
+     * Every component was colored.
+     */
+    Colored,
+    /**
+     * Some component has no interval coloring.
+     */
+    Infeasible,
+    /**
+     * Search of some component was stopped by a limit, so nothing is proven about it.
+     */
+    LimitReached
+};
+
+/**
+ * Bounds that keep exact search usable on large inputs, 0 means no bound.
+ */
+struct ExactLimits {
+    /**
+     * Components with more edges are not searched at all.
+     */
+    int maxEdges = 2000;
+    long long maxNodes = 0;
+    double maxSeconds = 60;
+    /**
+     * Set by another thread to stop the search as if a limit was reached. Not owned.
+     */
+    const std::atomic<bool>* cancelled = nullptr;
+};
+
+/**
+ * Decide by branch and bound whether every connected component of graph has
+ * an interval edge coloring and find one if it does.
+ *
+ * Edges are the variables. A vertex of degree d whose colors span [a, b]
+ * allows only unused colors in [b - d + 1, a + d - 1]. Colors of a connected
+ * graph span at most 2|V| - 3 (Asratian and Kamalian) and every coloring can
+ * be shifted, so the first edge gets a fixed color and the span is bounded;
+ * reversed colorings are ruled out by limiting an edge next to it. Regular
+ * graphs of odd order are rejected at once, as their degree many colors never
+ * suffice. Color windows of vertices are kept on the search trail, narrowed on
+ * assignment and restored on backjump. After each assignment the edge with
+ * the smallest domain is colored next, provided that edges at every vertex
+ * can still be matched to an interval of its degree. A wiped out domain or
+ * vertex is explained by the assignments that caused it, search jumps back to
+ * the latest of them and explanations of exhausted edges are kept as nogoods
+ * pruning colors of the edges colored later.
+ *
+ * Existing colors and constraints of graph are ignored. Colored components are
+ * moved to outGraph with colors starting at 1, other components stay in graph.
+ * If stats is not null, backtrackNodes counts search nodes.
+ */
+ExactResult colorExact(Graph& graph, Graph& outGraph, const ExactLimits& limits = ExactLimits(),
+    SolverStats* stats = nullptr);
+#endif //EXACT_SOLVER_H
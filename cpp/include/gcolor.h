@@ -0,0 +1,104 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef GCOLOR_H
+#define GCOLOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "exact_solver.h"
+#include "solver_stats.h"
+
+/**
+ * Outcome of colorEdges.
+ */
+enum class ColoringStatus {
+    /**
+     * Every edge was colored.
+     */
+    Colored,
+    /**
+     * The solver gave up or was cancelled, some edges are not colored.
+     */
+    Failed,
+    /**
+     * Exact search proved that some component has no interval coloring.
+     */
+    Infeasible,
+    /**
+     * Exact search of some component was stopped by a limit.
+     */
+    LimitReached,
+    /**
+     * Input has a loop or no edge array; nothing was colored.
+     */
+    InvalidInput
+};
+
+/**
+ * Choice of solver for colorEdges.
+ */
+struct ColoringOptions {
+    /**
+     * Workers coloring components, see colorComponents.
+     */
+    unsigned numThreads = 1;
+    /**
+     * More than 1 races that many differently configured solvers, see colorPortfolio.
+     */
+    unsigned numInstances = 1;
+    /**
+     * Search exhaustively within exactLimits instead, see colorExact.
+     */
+    bool exact = false;
+    /**
+     * Bounds of exact search; its cancelled flag is replaced by the one below.
+     */
+    ExactLimits exactLimits;
+    /**
+     * Seed of the default solver, see SolverConfig.
+     */
+    unsigned seed = 0;
+    /**
+     * Set by another thread to stop the solver. The default solver and the
+     * portfolio then fail, exact search reports LimitReached. Not owned.
+     */
+    const std::atomic<bool>* cancelled = nullptr;
+};
+
+/**
+ * Coloring of an edge list together with its outcome.
+ */
+struct ColoringResult {
+    ColoringStatus status = ColoringStatus::InvalidInput;
+    /**
+     * Color of every input edge in input order, 0 if it was not colored.
+     */
+    std::vector<int> colors;
+    SolverStats stats;
+};
+
+/**
+ * Color the graph whose i-th edge joins vertices ends[2i] and ends[2i + 1]
+ * (any int ids). colors must have room for numEdges colors and receives color
+ * of every edge in input order, 0 if it was not colored; an edge listed again,
+ * in either direction, gets the same color.
+ *
+ * Nothing is read from or written to files or the console and colors go to
+ * the caller's buffer. The solver logs at debug level and below only (see
+ * log.h). If stats is not null, it receives solver counters.
+ */
+ColoringStatus colorEdges(const int* ends, const size_t numEdges, int* colors,
+    const ColoringOptions& options = ColoringOptions(), SolverStats* stats = nullptr);
+
+/**
+ * Color graph given as list of edges, see colorEdges above.
+ */
+ColoringResult colorEdges(const std::vector<std::pair<int, int> >& edges,
+    const ColoringOptions& options = ColoringOptions());
+#endif //GCOLOR_H
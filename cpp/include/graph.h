@@ -9,15 +9,57 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <queue>
 #include <set>
 
 #include "edge.h"
+#include "csr_graph.h"
+#include "graph_loader.h"
+#include "color_summary.h"
+#include "color_set.h"
+#include "pair_table.h"
+#include "log.h"
+#include "solver_stats.h"
+#include "solver_config.h"
+#include "cycle_decomposition.h"
+#include "block_decomposition.h"
 
 using AdjList = std::map<int, std::vector<Edge>>;
 using VertexLabels = std::map<int, bool>;
-using VertexConstraints = std::map<int, std::set<int>>;
+using VertexConstraints = std::map<int, ColorSet>;
 
-extern bool verbose;
+class Graph;
+class GraphPool;
+
+/**
+ * Stable reference to an edge of a graph, oriented from v1 to v2.
+ * It holds edge id, so it stays valid when other edges are added or removed
+ * and is dereferenced in O(1).
+ */
+class EdgeHandle {
+public:
+    EdgeHandle() {}
+    EdgeHandle(const Graph* graph, const int id, const bool reversed)
+        : graph(graph), edgeId(id), reversed(reversed) {}
+
+    int id() const { return edgeId; }
+    /**
+     * Check if handle refers to an edge that is still in the graph and not parked.
+     */
+    bool isValid() const;
+    int v1() const;
+    int v2() const;
+    int color() const;
+    /**
+     * Return snapshot of the edge oriented as this handle.
+     */
+    Edge operator*() const { return Edge(v1(), v2(), color()); }
+    Edge operator->() const { return **this; }
+private:
+    const Graph* graph = nullptr;
+    int edgeId = -1;
+    bool reversed = false;
+};
 
 /**
  * Main class of a graph
@@ -27,9 +69,17 @@ public:
     /**
      * Constructor.
      * Reas graph from file and fill adjacency list.
+     * File may be an adjacency list or a binary graph (detected by its header).
      */
     Graph(std::string fileName);
 
+    /**
+     * Constructor.
+     * Read graph from a buffer holding an adjacency list or a binary graph,
+     * like contents of a file read by Graph(fileName).
+     */
+    Graph(const char* data, const size_t size);
+
     /**
      * Constructor.
      * Initialize graph from adjacency list.
@@ -37,10 +87,23 @@ public:
     Graph(AdjList& a);
 
     /**
-     * Return adjacency list
+     * Constructor.
+     * Initialize uncolored graph from adjacency rows (see AdjacencyRows). Edges
+     * get ids in order of their first appearance, loops are skipped.
+     */
+    explicit Graph(const AdjacencyRows& rows);
+
+    /**
+     * Return adjacency list.
+     * The list is a snapshot of the CSR core, rebuilt only after modifications.
      */
     const AdjList& getAdj() const;
 
+    /**
+     * Check if graph has no vertices.
+     */
+    bool isEmpty() const;
+
     /**
      * Add edge to the graph.
      */
@@ -52,19 +115,40 @@ public:
     void serialize(std::string fileName) const;
 
     /**
-     * Constructor.
-     * Read graph from file and fills adjacency list.
+     * Serialize graph with its coloring to binary format (see binary_format.h).
+     * Return false if file cannot be written.
      */
-    std::vector<Edge*> pathEdges(const std::vector<int>& elem);
+    bool serializeBinary(std::string fileName) const;
 
     /**
-     * Recursively color path in graph.
+     * Serialize graph as adjacency list, the text input format. Colors are not saved.
+     */
+    void serializeAdjacency(std::string fileName) const;
+
+    /**
+     * Return edges along given sequence of vertices.
+     * Each edge is oriented so that v1 precedes v2 on the path.
+     */
+    std::vector<EdgeHandle> pathEdges(const std::vector<int>& elem) const;
+
+    /**
+     * Color path in graph by backtracking, starting at a constrained vertex.
+     */
+    bool colorPath(std::vector<EdgeHandle> edges);
+    /**
+     * Color path or cycle (path returning to its first vertex) in graph by
+     * dynamic programming over colors of consecutive edges. As in colorPath
+     * no vertex but the last one of a path may be left with gaps, and the
+     * last one may not miss more colors than it has uncolored edges besides
+     * the path. Unlike colorPath it fails only if there is no such coloring,
+     * in O(length * largest color) time. Paths visiting a vertex twice are
+     * colored by colorPath.
      */
-    bool colorPath(std::vector<Edge*> edges);
+    bool colorPathDP(const std::vector<EdgeHandle>& edges);
     /**
      * Clears given path (set color 0) in graph.
      */
-    void zeroPath(std::vector<Edge*>::iterator edge, std::vector<Edge*>::iterator end);
+    void zeroPath(std::vector<EdgeHandle>::iterator edge, std::vector<EdgeHandle>::iterator end);
     /**
      * Determines possible coloring for given vertex considering current constraints.
      */
@@ -75,8 +159,14 @@ public:
     void colorEdge(const int v1, const int v2, const int color);
     /**
      * Return edge adjacent to v1 and v2.
+     * Use colorEdge to change its color, so that vertex summaries stay valid.
      */
-    Edge& getEdge(const int v1, const int v2);
+    const Edge& getEdge(const int v1, const int v2);
+    /**
+     * Return edges adjacent to given vertex, with v1 set to vertexIndex.
+     * Empty if the vertex is not in graph.
+     */
+    std::vector<Edge> edgesOf(const int vertexIndex) const;
     /**
      * Check if interval of coloring of edges adjacent to vertexIndex doesn't have gaps
      */
@@ -90,9 +180,18 @@ public:
      */
     int getHighestColor(const int vertexIndex) const;
     /**
-     * Recursively search for cycle in the graph.
+     * Search for a cycle through the vertex with smallest id (depth-first).
+     * Return its vertices, first vertex repeated at the end, or empty vector.
      */
     std::vector<int> findCycle();
+    /**
+     * Return next cycle from the cycle decomposition of the graph, in the format
+     * of findCycle. Decomposition is computed in one pass and reused until edges
+     * are added; cycles that lost edges meanwhile are skipped. The cycle whose
+     * vertices are most constrained (see tightnessAt) comes first; cycles through
+     * vertices that got constraints since the last call are requeued.
+     */
+    std::vector<int> nextCycle();
     /**
      * Color this graph assuming it is forest considering vertex constraints.
      */
@@ -103,22 +202,64 @@ public:
      * Move single edge from this graph to other including constraints on vertices v1 and v2.
      */
     void moveEdgeToAnotherGraph(Graph& other, const int v1, const int v2);
+    /**
+     * Move single edge given by handle from this graph to other including constraints 
+     * on its vertices.
+     */
+    void moveEdgeToAnotherGraph(Graph& other, const EdgeHandle& edge);
     /**
      * Move all edges from this graph to other including constraints on vertices.
      */
     void moveAllEdgesToAnotherGraph(Graph& other);
     /**
-     * Move all hanging edges from this graph to outGraph.
+     * Move all hanging edges from this graph to outGraph, repeatedly, so that
+     * whole trees hanging off cycles are moved. Runs in O(V + E) using a
+     * worklist of vertices with a single edge.
      * Return true if at least one edge was moved. False otherwise.
      */
     bool moveHangingEdgesTo(Graph& outGraph);
+    /**
+     * Return edges moved into this graph by moveHangingEdgesTo, in the order
+     * they were peeled, as (hanging vertex, its neighbour) pairs.
+     */
+    const std::vector<std::pair<int, int> >& getPeelOrder() const { return peelOrder; }
     /**
      * Main function for graph coloring.
      * Return true if graph can be consecutive colored. False otherwise.
      */
     bool color(Graph& outGraph);
     /**
-     * Print this graph including constraints.
+     * Split graph into connected components, each a separate graph with its
+     * edges, colors and vertex constraints. Components are ordered by their
+     * first vertex; vertices without edges are left out.
+     */
+    std::vector<Graph> splitComponents() const;
+    /**
+     * Split graph into biconnected blocks (see BlockDecomposition), each a
+     * separate graph with its edges, colors and vertex constraints. Cut
+     * vertices appear in every block they belong to.
+     */
+    std::vector<Graph> splitBlocks() const;
+    /**
+     * Check if graph has no colored edges and no vertex constraints.
+     */
+    bool isUncolored() const;
+    /**
+     * Count work of the solver in given stats (null disables counting).
+     * Graphs created by the solver share stats of the graph that created them.
+     */
+    void setStats(SolverStats* solverStats) { stats = solverStats; }
+    /**
+     * Use given solver choices and cancellation flag (null means defaults).
+     * Graphs created by the solver share config of the graph that created them.
+     */
+    void setConfig(SolverConfig* solverConfig) { config = solverConfig; }
+    /**
+     * Remove all edges and constraints. Memory is kept for reuse.
+     */
+    void clear();
+    /**
+     * Print this graph including constraints to the log at trace level.
      */
     void print() const;
     /**
@@ -133,6 +274,15 @@ public:
      * Add single constraint to set of constraints for vertexIndex
      */
     void addVertexConstraint(const int vertexIndex, const int color);
+    /**
+     * Remove constraints of all vertices, edges keep their colors.
+     */
+    void clearVertexConstraints();
+    /**
+     * Return summary of colors seen at vertex: lowest, highest, number of distinct
+     * colors and duplicates. Colors of edges and constraints are both included.
+     */
+    const ColorSummary& summaryOf(const int vertexIndex) const;
     /**
      * Return all constraints for single vertex.
      * Constraints are real colorings of edges plus artificial constraints from constraints map
@@ -151,9 +301,17 @@ public:
     * Return number of edges in graph.
     */
     int numEdges() const;
+    /**
+    * Return number of vertices in graph.
+    */
+    int numVertices() const { return core.numVertices(); }
 
     /**
-     * Recursively find path in graph.
+     * Find path in graph (depth-first), starting at the most constrained vertex
+     * (see tightnessAt, smallest id among equal ones, a random one with a seed)
+     * and preferably ending at another constrained vertex or a leaf. Constrained
+     * vertices are kept in a priority queue between calls and only vertices
+     * whose colors or degree changed are queued again.
      */
     std::vector<int> findPath();
 private:
@@ -162,40 +320,211 @@ private:
      */
     void deserialize(std::string fileName);
     /**
-     * Recursively find path in graph.
+     * Fill graph from adjacency list or binary graph in buffer.
+     * Return false if binary graph is invalid, graph stays empty then.
+     */
+    bool load(const char* data, const size_t size);
+    /**
+     * colorAsForest taking its temporary graphs from pool.
+     */
+    bool colorAsForest(GraphPool& pool);
+    /**
+     * Color edges in given order by backtracking on an explicit stack.
+     * An edge keeps its color only if it leaves no gap at its v1 once the
+     * rest of the path is colored. After every assignment a checked vertex
+     * may not miss more colors than it has uncolored path edges left, so
+     * dead ends are left early. Colors that leave fewer gaps at v2 are
+     * tried first. Failed levels undo their changes from the trail, so
+     * colors path edges had before are restored.
      */
-    bool colorPathRecur(std::vector<Edge*>::iterator edge, std::vector<Edge*>::iterator end);
+    bool backtrackPath(std::vector<EdgeHandle>& edges);
     /**
-     * Recursively color cycle.
+     * Number of colors missing from the interval of colors of vertex after
+     * adding color to them.
      */
-    std::vector<int> findCycleRecur(const int startingVertexIdx, 
-        const int currentVertexIdx, const int prevIdx);
+    int gapsWith(const int vertexIndex, const int color) const;
     /**
-     * Return first hanging edge in graph.
-     * Hanging edge is adjacent to vertices that have adjacency list of size 1.
+     * Depth-first search for a cycle through dense vertex start.
      */
-    Edge* findHangingEdge();
+    std::vector<int> findCycleFrom(const int start);
     /**
-     * Print this, temp and out graphs only if in verbose mode.
+     * Print this, temp and out graphs to the log at trace level.
      */
     void printGraphs(const Graph& temp, const Graph& out) const;
     /**
-     * Recursively find path in graph.
+     * Depth-first search for a path from dense vertex start to a leaf or,
+     * if mustEndWithConstrained, to a constrained vertex.
      */
-    std::vector<int> findPathRecur(const int startingVertexIdx, 
-        const int currentVertexIdx, const bool mustEndWithConstrained);
+    std::vector<int> findPathFrom(const int start, const bool mustEndWithConstrained);
+    /**
+     * Start a new search: all vertices become unvisited in O(1).
+     */
+    void startVisit();
+    bool isVisited(const int v) const { return visitMarks[v] == visitEpoch; }
+    void visit(const int v) { visitMarks[v] = visitEpoch; }
+    /**
+     * Summary of dense vertex (-1 gives empty summary).
+     */
+    const ColorSummary& summaryAt(const int v) const;
+
+    /**
+     * Add constraints of given vertex to the same vertex of other graph.
+     */
+    void copyConstraintsTo(Graph& other, const int vertexIndex) const;
+    /**
+     * Return colors of edges and constraints of given vertex.
+     */
+    ColorSet allColorsOf(const int vertexIndex) const;
+
+    /**
+     * Park edges that failed to color (see CsrGraph::parkEdge) and return
+     * their ids. Parked edges are invisible to searches and their colors do
+     * not count at their vertices, but they keep ids and share constraints
+     * of this graph; parking and restoring an edge is O(1).
+     */
+    std::vector<int> parkEdges(const std::vector<EdgeHandle>& edges);
+    /**
+     * Put parked edges back.
+     */
+    void restoreEdges(const std::vector<int>& fragment);
+
+    /**
+     * Return id of edge adjacent to v1 and v2 or -1 if there is none.
+     */
+    int edgeId(const int v1, const int v2) const;
+    /**
+     * Set color of edge and update summaries of its endpoints.
+     * While recording, the previous color is pushed on the trail.
+     */
+    void setEdgeColor(const int e, const int color);
+    /**
+     * Restore colors changed since trail had mark entries, latest first, and
+     * return how many changes were undone. Cost is proportional to that number.
+     */
+    size_t undoTrail(const size_t mark);
+    /**
+     * Update color counts and summary of dense vertex v.
+     * edgeDelta is the change of number of edges with this color,
+     * constraintDelta the change of constraint presence.
+     */
+    void countColor(const int v, const int color, const int edgeDelta, 
+        const int constraintDelta);
+    /**
+     * Recompute lowest and highest color of dense vertex v.
+     */
+    void refreshSummary(const int v) const;
+    /**
+     * How constrained dense vertex v is: 0 without colors, otherwise larger
+     * for more fixed colors and, among equal ones, for less room to extend them.
+     */
+    long long tightnessAt(const int v) const;
+    /**
+     * Mark dense vertex v to be queued again among starts of findPath.
+     */
+    void touchPathStart(const int v);
+    /**
+     * Queue dense vertex v among starts of findPath if it is constrained.
+     */
+    void queuePathStart(const int v);
 
     /**
-     * Adjacency lists for all vertices in graph.
+     * Graph structure: vertices, adjacency and a single record per undirected edge.
+     */
+    CsrGraph core;
+    /**
+     * Adjacency list snapshot returned by getAdj.
+     */
+    mutable AdjList adjView;
+    /**
+     * Determines if adjView has to be rebuilt.
+     */
+    mutable bool adjViewDirty = true;
+    /**
+     * Vertex is visited in current cycle or path search if its mark equals visitEpoch.
+     */
+    std::vector<unsigned> visitMarks;
+    unsigned visitEpoch = 0;
+    /**
+     * Cycles handed out by nextCycle and whether edges were added since it was built.
+     */
+    CycleDecomposition cycles;
+    bool cyclesDirty = true;
+    /**
+     * Dense vertices whose constraints changed since cycles were last prioritized.
+     */
+    std::vector<int> retouched;
+    /**
+     * Constrained vertex queued as start of findPath. Entries older than
+     * version of their vertex are stale.
+     */
+    struct PathStart {
+        long long tightness;
+        unsigned tie;
+        int v;
+        unsigned version;
+        bool operator<(const PathStart& other) const {
+            return tightness < other.tightness || (tightness == other.tightness && tie > other.tie);
+        }
+    };
+    /**
+     * Starts of findPath by tightness, built on its first call and updated
+     * from pathTouched: vertices whose colors or degree changed since.
      */
-    AdjList adj;
+    std::priority_queue<PathStart> pathStarts;
+    std::vector<unsigned> pathVersions;
+    std::vector<int> pathTouched;
+    std::vector<char> pathTouchedMark;
+    bool pathsDirty = true;
     /**
-     * Map of logical values for every vertex detemining if it was visited in cycle or path search.
+     * Edges received from moveHangingEdgesTo, in peel order.
      */
-    VertexLabels labels;
+    std::vector<std::pair<int, int> > peelOrder;
     /**
      * Color constraints put on each vertex in graph.
      */
     VertexConstraints constraints;
+    /**
+     * Color summary for every dense vertex.
+     */
+    mutable std::vector<ColorSummary> summaries;
+    /**
+     * For (dense vertex, color): twice the number of edges with that color
+     * plus one if color is also a constraint.
+     */
+    PairTable colorCounts;
+    /**
+     * Edge ids and colors they had before changes made by backtrackPath,
+     * recorded only while recordingTrail is set.
+     */
+    std::vector<std::pair<int, int> > trail;
+    bool recordingTrail = false;
+    /**
+     * Counters of the solver, not owned. Null if not counting.
+     */
+    SolverStats* stats = nullptr;
+    /**
+     * Choices of the solver, not owned. Null for defaults.
+     */
+    SolverConfig* config = nullptr;
+
+    friend class EdgeHandle;
 };
+
+inline bool EdgeHandle::isValid() const {
+    return graph && graph->core.isEdge(edgeId);
+}
+
+inline int EdgeHandle::v1() const {
+    const Edge& e = graph->core.edge(edgeId);
+    return reversed ? e.v2 : e.v1;
+}
+
+inline int EdgeHandle::v2() const {
+    const Edge& e = graph->core.edge(edgeId);
+    return reversed ? e.v1 : e.v2;
+}
+
+inline int EdgeHandle::color() const {
+    return graph->core.edge(edgeId).color;
+}
 #endif //GRAPH_H
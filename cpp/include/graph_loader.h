@@ -0,0 +1,66 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef GRAPH_LOADER_H
+#define GRAPH_LOADER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Adjacency list input in row form: every row is a vertex followed by its neighbours.
+ * Neighbours of row r are neighbourIds[rowOffsets[r]] .. neighbourIds[rowOffsets[r+1]-1].
+ */
+struct AdjacencyRows {
+    std::vector<int> rowIds;
+    std::vector<size_t> rowOffsets{0};
+    std::vector<int> neighbourIds;
+};
+
+/**
+ * Read-only memory mapping of a whole file.
+ */
+class MappedFile {
+public:
+    /**
+     * Map given file. Check isOpen() for success.
+     */
+    explicit MappedFile(const std::string& fileName);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return open; }
+    const char* data() const { return begin; }
+    size_t size() const { return length; }
+private:
+    const char* begin = nullptr;
+    size_t length = 0;
+    bool open = false;
+    bool mapped = false;
+    /**
+     * Used instead of mapping when file cannot be mapped (e.g. a pipe).
+     */
+    std::vector<char> buffer;
+};
+
+/**
+ * Parse adjacency list text. Input is split into line-aligned chunks
+ * parsed concurrently; rows are returned in input order.
+ * Lines without a leading integer are skipped and a line ends at
+ * the first token that is not an integer.
+ * numThreads = 0 picks number of threads based on input size.
+ */
+void parseAdjacencyRows(const char* begin, const char* end, AdjacencyRows& rows,
+    unsigned numThreads = 0);
+
+/**
+ * Memory-map file and parse it with parseAdjacencyRows.
+ * Return false if file cannot be read.
+ */
+bool loadAdjacencyRows(const std::string& fileName, AdjacencyRows& rows,
+    unsigned numThreads = 0);
+#endif //GRAPH_LOADER_H
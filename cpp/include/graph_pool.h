@@ -0,0 +1,39 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef GRAPH_POOL_H
+#define GRAPH_POOL_H
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include "graph.h"
+
+/**
+ * Owns temporary graphs of one solve: working graphs, path graphs and
+ * fragments waiting in the queue. Released graphs keep their memory and are
+ * handed out again; all graphs are freed together with the pool.
+ */
+class GraphPool {
+public:
+    /**
+     * Return an empty graph counting work in stats and using given config.
+     * It stays valid until the pool is destroyed.
+     */
+    Graph& acquire(SolverStats* stats, SolverConfig* config = nullptr);
+    /**
+     * Drop contents of graph and keep it for reuse.
+     */
+    void release(Graph& graph);
+    /**
+     * Number of graphs created by the pool.
+     */
+    size_t size() const { return graphs.size(); }
+private:
+    std::deque<Graph> graphs;
+    std::vector<Graph*> unused;
+};
+#endif //GRAPH_POOL_H
@@ -0,0 +1,136 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+/**
+ * Log levels, from least to most detailed.
+ */
+enum class LogLevel : int {
+    Error = 0,
+    Info = 1,
+    Debug = 2,
+    Trace = 3
+};
+
+/**
+ * Most detailed level compiled in. Calls above it are removed by the
+ * preprocessor, arguments included. Debug builds define it as 3 (trace).
+ */
+#ifndef GCOLOR_LOG_FLOOR
+#define GCOLOR_LOG_FLOOR 2
+#endif
+
+/**
+ * Level selected by --verbose: the most detailed one compiled in, so that
+ * it prints solver progress in release builds too.
+ */
+const LogLevel VERBOSE_LOG_LEVEL = GCOLOR_LOG_FLOOR >= 3 ? LogLevel::Trace : LogLevel::Debug;
+
+/**
+ * Most detailed level written at runtime, Info by default.
+ */
+extern LogLevel logLevel;
+
+/**
+ * Check if messages of given level are written.
+ */
+inline bool logEnabled(const LogLevel level) {
+    return (int)level <= GCOLOR_LOG_FLOOR && level <= logLevel;
+}
+
+/**
+ * Parse level name (error, info, debug, trace). Return false if unknown.
+ */
+bool parseLogLevel(const std::string& name, LogLevel& level);
+
+/**
+ * Append line to the log buffer. Buffer goes to the sink when it is full,
+ * on errors, on flushLog() and at exit.
+ */
+void logWrite(const LogLevel level, const std::string& line);
+
+/**
+ * Write buffered messages to the sink.
+ */
+void flushLog();
+
+/**
+ * Set sink of the log; null, the default, discards messages, so that the
+ * library prints nothing unless a program asks for it. Buffered messages are
+ * flushed first.
+ */
+void setLogSink(std::FILE* sink);
+
+/**
+ * Single log message, written to the log when destroyed.
+ */
+class LogLine {
+public:
+    explicit LogLine(const LogLevel level) : level(level) {}
+    ~LogLine() {
+        stream << '\n';
+        logWrite(level, stream.str());
+    }
+
+    template<typename T>
+    LogLine& operator<<(const T& value) {
+        stream << value;
+        return *this;
+    }
+private:
+    const LogLevel level;
+    std::ostringstream stream;
+};
+
+/**
+ * Wrapper printing a container as "a, b, c, ".
+ */
+template<typename Container>
+struct LogList {
+    const Container& items;
+};
+
+template<typename Container>
+LogList<Container> logList(const Container& items) {
+    return LogList<Container>{items};
+}
+
+template<typename Container>
+std::ostream& operator<<(std::ostream& os, const LogList<Container>& list) {
+    for(const auto& item : list.items) {
+        os << item << ", ";
+    }
+    return os;
+}
+
+#define GCOLOR_LOG(level, message) \
+    do { if(logEnabled(level)) { LogLine(level) << message; } } while(false)
+
+#define LOG_ERROR(message) GCOLOR_LOG(LogLevel::Error, message)
+
+#if GCOLOR_LOG_FLOOR >= 1
+#define LOG_INFO(message) GCOLOR_LOG(LogLevel::Info, message)
+#else
+#define LOG_INFO(message) do {} while(false)
+#endif
+
+#if GCOLOR_LOG_FLOOR >= 2
+#define LOG_DEBUG(message) GCOLOR_LOG(LogLevel::Debug, message)
+#else
+#define LOG_DEBUG(message) do {} while(false)
+#endif
+
+#if GCOLOR_LOG_FLOOR >= 3
+#define LOG_TRACE(message) GCOLOR_LOG(LogLevel::Trace, message)
+#else
+#define LOG_TRACE(message) do {} while(false)
+#endif
+#endif //LOG_H
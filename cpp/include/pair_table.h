@@ -0,0 +1,58 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef PAIR_TABLE_H
+#define PAIR_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Open addressing hash table mapping ordered pair of ints to int.
+ * First element of the pair must be non-negative.
+ */
+class PairTable {
+public:
+    /**
+     * Return value stored for pair (a, b) or -1 if there is none.
+     */
+    int find(const int a, const int b) const;
+    /**
+     * Insert value for pair (a, b). Pair must not be present.
+     */
+    void insert(const int a, const int b, const int value);
+    /**
+     * Add delta to value stored for pair (a, b), treating missing pair as 0.
+     * Pair is removed when its value drops to 0. Return new value.
+     */
+    int add(const int a, const int b, const int delta);
+    /**
+     * Remove pair (a, b) from index.
+     */
+    void erase(const int a, const int b);
+    /**
+     * Remove everything.
+     */
+    void clear();
+    /**
+     * Prepare table for given number of entries.
+     */
+    void reserve(const size_t numEntries);
+private:
+    static uint64_t key(const int a, const int b);
+    static size_t hash(const uint64_t key);
+    void grow();
+    size_t slotOf(const uint64_t key) const;
+
+    static const uint64_t EMPTY = ~uint64_t(0);
+    static const uint64_t ERASED = ~uint64_t(0) - 1;
+
+    std::vector<uint64_t> keys;
+    std::vector<int> values;
+    size_t used = 0;
+    size_t live = 0;
+};
+#endif //PAIR_TABLE_H
@@ -0,0 +1,31 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+
+#include <atomic>
+
+#include "graph.h"
+#include "solver_config.h"
+#include "solver_stats.h"
+
+/**
+ * Color copies of graph with numInstances differently configured solvers
+ * running concurrently, each through colorComponents with numThreads
+ * workers. Instance 0 uses default choices, instance i seed i and reach
+ * 2 + i % 2 (see SolverConfig). The first instance that colors the graph
+ * cancels the others and its coloring is moved to outGraph; if all fail,
+ * result of instance 0 is used. Edges left uncolored stay in graph.
+ *
+ * Which instance wins may depend on timing. If stats is not null, it
+ * receives stats of the instance whose result was used, with totalTime
+ * being the wall time of the whole call. Setting cancelled from another
+ * thread stops every instance, which then fail.
+ */
+bool colorPortfolio(Graph& graph, Graph& outGraph, unsigned numInstances,
+    unsigned numThreads = 1, SolverStats* stats = nullptr,
+    const std::atomic<bool>* cancelled = nullptr);
+#endif //PORTFOLIO_H
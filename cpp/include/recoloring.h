@@ -0,0 +1,47 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef RECOLORING_H
+#define RECOLORING_H
+
+#include "graph.h"
+#include "solver_stats.h"
+
+/**
+ * Insertion or deletion of a single edge of a colored graph.
+ */
+struct EdgeEdit {
+    enum Kind { Insert, Delete };
+
+    Kind kind;
+    int v1;
+    int v2;
+
+    EdgeEdit(Kind kind, int v1, int v2) : kind(kind), v1(v1), v2(v2) {}
+};
+
+/**
+ * Apply edits to an interval colored graph (as produced by color) in order and
+ * repair its coloring around the touched vertices, that is the ends of edits.
+ * Inserting an existing edge, deleting a missing one and loops are ignored.
+ * Vertex constraints of graph, like those color leaves behind, are removed.
+ *
+ * Each inserted edge first gets a color that extends intervals at both its
+ * ends, if there is one. If touched vertices are still not colored properly,
+ * edges within 1, 2 and then 4 hops of them are uncolored and colored again by
+ * the solver, with colors of edges leaving that ball fixed as constraints of
+ * their ends. Only if all of that fails, the whole components containing
+ * touched vertices are colored from scratch (see colorComponents) on
+ * numThreads workers, falling back to a short exact search (see colorExact)
+ * for components the heuristic fails on. Other edges keep their colors.
+ *
+ * Return true if graph is colored properly at every touched vertex afterwards.
+ * On failure edits are applied, but inserted edges may stay uncolored (0).
+ * If stats is not null, it receives sum of the stats of every re-solve, except
+ * vertices, edges and totalTime, which describe graph and the whole call.
+ */
+bool recolor(Graph& graph, const std::vector<EdgeEdit>& edits, unsigned numThreads = 1,
+    SolverStats* stats = nullptr);
+#endif //RECOLORING_H
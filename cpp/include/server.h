@@ -0,0 +1,129 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "thread_pool.h"
+
+/**
+ * Limits of the solver daemon.
+ */
+struct ServerOptions {
+    /**
+     * Workers coloring graphs, 0 means one per hardware thread.
+     */
+    unsigned numThreads = 1;
+    /**
+     * Requests read but not answered yet, over all connections. When there
+     * are that many, connections are not read until some request is answered,
+     * so that clients sending faster than graphs are colored block. A
+     * connection is not read either while its answers wait for the client to
+     * take them, or while it has that many requests unanswered.
+     */
+    size_t maxQueued = 256;
+    /**
+     * Longest request; a connection sending a longer one gets an error and is closed.
+     */
+    size_t maxRequestBytes = 256 << 20;
+};
+
+/**
+ * Solver daemon on a Unix domain socket.
+ *
+ * A connection carries any number of requests, each colored on the worker
+ * pool as soon as it is read, so that clients may send requests without
+ * waiting for answers. Answers come in request order. A request is either
+ *   adjacency list text (as in input files) ended by an empty line, or
+ *   a line "binary <n>" followed by n bytes of a binary graph (.gcb).
+ * Blank lines between requests are skipped and text left when the client
+ * stops sending is a request too. The answer to every request is a line
+ * "ok <m>" or "failed <m>" followed by m lines "<v1> <v2> <color>", one per
+ * edge (color 0 if it was not colored), and an empty line. A request that
+ * cannot be read gets "error <message>" and an empty line.
+ */
+class Server {
+public:
+    explicit Server(const ServerOptions& options = ServerOptions());
+    /**
+     * Stop serving, see run.
+     */
+    ~Server();
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    /**
+     * Create socket at given path, replacing a stale one.
+     * Return false if it cannot be created.
+     */
+    bool listen(const std::string& socketPath);
+    /**
+     * Accept connections until stop is called, then stop reading them, drop
+     * requests received in part, answer requests already read, close them and
+     * remove the socket. A client that takes no answer for a second is closed
+     * without the rest.
+     */
+    void run();
+    /**
+     * Make run return. Safe to call from other threads and signal handlers.
+     */
+    void stop();
+private:
+    struct Connection;
+
+    /**
+     * Read requests of connection, hand them to workers and write their
+     * answers in order until it is closed. Only this thread uses the socket,
+     * which is non-blocking, so that a client not reading its answers stalls
+     * no worker.
+     */
+    void serve(const std::shared_ptr<Connection>& connection);
+    /**
+     * Color request on the pool and answer it once earlier requests are answered.
+     */
+    void submit(const std::shared_ptr<Connection>& connection, std::string request);
+    /**
+     * Leave answer to request number sequence for the connection's thread to write.
+     */
+    void answer(Connection& connection, const unsigned long long sequence, std::string text);
+    /**
+     * Make run check the stop flag and join finished readers.
+     */
+    void wakeRun();
+    /**
+     * Join readers of closed connections.
+     */
+    void reapReaders(const bool all);
+
+    const ServerOptions options;
+    ThreadPool pool;
+    std::string path;
+    int listenFd = -1;
+    /**
+     * Written by stop and finished readers to wake run.
+     */
+    int wakeFds[2] = {-1, -1};
+
+    std::mutex queueMutex;
+    std::condition_variable queueFreed;
+    size_t queued = 0;
+    std::atomic<bool> stopping{false};
+
+    struct Reader {
+        std::shared_ptr<Connection> connection;
+        std::thread thread;
+    };
+    std::vector<Reader> readers;
+};
+#endif //SERVER_H
@@ -0,0 +1,48 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef SOLVER_CONFIG_H
+#define SOLVER_CONFIG_H
+
+#include <atomic>
+#include <random>
+
+/**
+ * Choices of the solver that do not affect validity of a coloring, and a
+ * flag to stop it. Shared by all graphs of one solve, so it must not be
+ * used by two threads at once.
+ */
+struct SolverConfig {
+    /**
+     * 0 keeps the default choices. Other seeds shuffle the order in which
+     * colors of an edge are tried and start cycle searches at random vertices.
+     */
+    unsigned seed = 0;
+    /**
+     * How far below the lowest and above the highest color of a vertex new
+     * colors are tried.
+     */
+    int reach = 2;
+    /**
+     * Set by another thread to stop the solver, which then fails. Not owned.
+     */
+    const std::atomic<bool>* cancelled = nullptr;
+    /**
+     * Flag of the caller of a solver that uses cancelled itself (see
+     * colorPortfolio), stops the solver too. Not owned.
+     */
+    const std::atomic<bool>* callerCancelled = nullptr;
+    std::mt19937 rng;
+
+    void reseed(const unsigned newSeed) {
+        seed = newSeed;
+        rng.seed(newSeed);
+    }
+    bool isCancelled() const {
+        return (cancelled && cancelled->load(std::memory_order_relaxed))
+            || (callerCancelled && callerCancelled->load(std::memory_order_relaxed));
+    }
+};
+#endif //SOLVER_CONFIG_H
@@ -0,0 +1,97 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef SOLVER_STATS_H
+#define SOLVER_STATS_H
+
+#include <chrono>
+#include <string>
+
+/**
+ * Work done by the solver for a single graph.
+ * Phases are timed where Graph::color calls them, so their times do not overlap.
+ */
+struct SolverStats {
+    int vertices = 0;
+    int edges = 0;
+    bool success = false;
+
+    long long cyclesFound = 0;
+    /**
+     * Paths produced by splitCycle.
+     */
+    long long pathsSplit = 0;
+    /**
+     * Backtracking steps of colorPath (states of colorPathDP) and edge colors
+     * colorPath had to reset.
+     */
+    long long backtrackNodes = 0;
+    long long backtrackUndone = 0;
+    long long queuePushes = 0;
+    long long queuePops = 0;
+    long long hangingEdgesPeeled = 0;
+    /**
+     * Iterations of the colorAsForest loop.
+     */
+    long long forestIterations = 0;
+    /**
+     * Nogoods learned by exact search.
+     */
+    long long nogoodsLearned = 0;
+
+    /**
+     * Wall time of phases in seconds.
+     */
+    double totalTime = 0;
+    double peelingTime = 0;
+    double cycleSearchTime = 0;
+    double pathColoringTime = 0;
+    double forestColoringTime = 0;
+
+    /**
+     * Add counters and phase times of other, e.g. of a separately colored component.
+     * Success becomes true only if both succeeded.
+     */
+    void add(const SolverStats& other);
+    /**
+     * Return statistics as a JSON object.
+     */
+    std::string toJson() const;
+    /**
+     * Write toJson() to file. Return false if file cannot be written.
+     */
+    bool writeJson(const std::string& fileName) const;
+};
+
+/**
+ * Adds wall time of its scope to a phase of stats. Does nothing if stats is null.
+ */
+class PhaseTimer {
+public:
+    PhaseTimer(SolverStats* stats, double SolverStats::* phase)
+        : stats(stats), phase(phase), start(std::chrono::steady_clock::now()) {}
+    ~PhaseTimer() {
+        if(stats) {
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            stats->*phase += elapsed.count();
+        }
+    }
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+private:
+    SolverStats* const stats;
+    double SolverStats::* const phase;
+    const std::chrono::steady_clock::time_point start;
+};
+
+/**
+ * Call f and add its wall time to a phase of stats.
+ */
+template<typename F>
+auto timePhase(SolverStats* stats, double SolverStats::* phase, F f) -> decltype(f()) {
+    PhaseTimer timer(stats, phase);
+    return f();
+}
+#endif //SOLVER_STATS_H
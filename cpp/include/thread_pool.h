@@ -0,0 +1,67 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of worker threads with work stealing.
+ *
+ * Every worker has its own deque. Tasks submitted from a worker go to its
+ * deque and it takes them newest first; idle workers steal the oldest task
+ * from other deques. Tasks submitted from outside are spread round-robin.
+ */
+class ThreadPool {
+public:
+    /**
+     * Start numThreads workers; 0 means one per hardware thread.
+     */
+    explicit ThreadPool(unsigned numThreads = 0);
+    /**
+     * Wait for all tasks and stop workers.
+     */
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+    /**
+     * Block until every submitted task has finished.
+     */
+    void wait();
+    unsigned size() const { return (unsigned)workers.size(); }
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()> > tasks;
+    };
+
+    void run(const unsigned worker);
+    bool tryPop(const unsigned worker, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<Queue> > queues;
+    std::vector<std::thread> workers;
+
+    std::mutex stateMutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    /**
+     * Tasks waiting in queues and tasks not finished yet.
+     */
+    size_t queued = 0;
+    size_t pending = 0;
+    unsigned nextQueue = 0;
+    bool stopping = false;
+};
+#endif //THREAD_POOL_H
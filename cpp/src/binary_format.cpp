@@ -0,0 +1,297 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include "../include/binary_format.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+const char BINARY_GRAPH_MAGIC[8] = {'G', 'C', 'O', 'L', 'O', 'R', 'B', '\n'};
+
+inline size_t align8(const size_t offset) {
+    return (offset + 7) & ~(size_t)7;
+}
+
+bool hostIsLittleEndian() {
+    const uint16_t one = 1;
+    char first;
+    memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+template<typename T>
+T byteSwapped(T value) {
+    char* bytes = (char*)&value;
+    std::reverse(bytes, bytes + sizeof(T));
+    return value;
+}
+
+template<typename T>
+void swapSection(char* data, const size_t count) {
+    T* values = (T*)data;
+    for(size_t i = 0; i < count; i++) {
+        values[i] = byteSwapped(values[i]);
+    }
+}
+
+/**
+ * Offsets of sections of a graph with n vertices and m edges, see BinaryGraphHeader.
+ */
+struct Layout {
+    size_t ids, offsets, neighbours, slotEdges, ends, colors, end;
+};
+
+Layout layoutOf(const uint64_t n, const uint64_t m) {
+    Layout layout;
+    layout.ids = align8(sizeof(BinaryGraphHeader));
+    layout.offsets = align8(layout.ids + n * sizeof(int32_t));
+    layout.neighbours = align8(layout.offsets + (n + 1) * sizeof(uint64_t));
+    layout.slotEdges = align8(layout.neighbours + 2 * m * sizeof(int32_t));
+    layout.ends = align8(layout.slotEdges + 2 * m * sizeof(int32_t));
+    layout.colors = align8(layout.ends + 2 * m * sizeof(int32_t));
+    layout.end = layout.colors + m * sizeof(int32_t);
+    return layout;
+}
+
+/**
+ * Write section of integers in little endian, padded to a multiple of 8 bytes.
+ */
+template<typename T>
+void writeSection(std::ofstream& file, const std::vector<T>& values) {
+    const size_t bytes = values.size() * sizeof(T);
+    if(hostIsLittleEndian()) {
+        file.write((const char*)values.data(), bytes);
+    } else {
+        std::vector<T> swapped(values);
+        swapSection<T>((char*)swapped.data(), swapped.size());
+        file.write((const char*)swapped.data(), bytes);
+    }
+    static const char padding[8] = {0};
+    file.write(padding, align8(bytes) - bytes);
+}
+
+}
+
+bool isBinaryGraph(const char* data, const size_t size) {
+    return size >= sizeof(BINARY_GRAPH_MAGIC)
+        && memcmp(data, BINARY_GRAPH_MAGIC, sizeof(BINARY_GRAPH_MAGIC)) == 0;
+}
+
+BinaryGraphView::BinaryGraphView(const std::string& fileName)
+    : file(new MappedFile(fileName)) {
+
+    if(file->isOpen()) {
+        validate(file->data(), file->size());
+    }
+}
+
+BinaryGraphView::BinaryGraphView(const char* data, const size_t size) {
+    validate(data, size);
+}
+
+void BinaryGraphView::validate(const char* data, const size_t size) {
+    if(size < sizeof(BinaryGraphHeader) || !isBinaryGraph(data, size)) {
+        return;
+    }
+    if(!hostIsLittleEndian()) {
+        // integers are stored little endian, bring a copy to host order
+        swapped.assign(data, data + size);
+        BinaryGraphHeader* swappedHeader = (BinaryGraphHeader*)swapped.data();
+        swappedHeader->version = byteSwapped(swappedHeader->version);
+        swappedHeader->flags = byteSwapped(swappedHeader->flags);
+        swappedHeader->numVertices = byteSwapped(swappedHeader->numVertices);
+        swappedHeader->numEdges = byteSwapped(swappedHeader->numEdges);
+        const uint64_t n = swappedHeader->numVertices, m = swappedHeader->numEdges;
+        if(n >= INT_MAX || m >= INT_MAX / 2) {
+            return;
+        }
+        const Layout layout = layoutOf(n, m);
+        if(layout.end > size) {
+            return;
+        }
+        swapSection<int32_t>(swapped.data() + layout.ids, n);
+        swapSection<uint64_t>(swapped.data() + layout.offsets, n + 1);
+        swapSection<int32_t>(swapped.data() + layout.neighbours, 2 * m);
+        swapSection<int32_t>(swapped.data() + layout.slotEdges, 2 * m);
+        swapSection<int32_t>(swapped.data() + layout.ends, 2 * m);
+        swapSection<int32_t>(swapped.data() + layout.colors, m);
+        data = swapped.data();
+    }
+    header = (const BinaryGraphHeader*)data;
+    const uint64_t n = header->numVertices, m = header->numEdges;
+    if(header->version != BINARY_GRAPH_VERSION || (header->flags & ~BINARY_GRAPH_SORTED) != 0
+        || n >= INT_MAX || m >= INT_MAX / 2) {
+        return;
+    }
+
+    const Layout layout = layoutOf(n, m);
+    if(layout.end > size) {
+        return;
+    }
+    ids = (const int32_t*)(data + layout.ids);
+    slotOffsets = (const uint64_t*)(data + layout.offsets);
+    slotNeighbours = (const int32_t*)(data + layout.neighbours);
+    edges = (const int32_t*)(data + layout.slotEdges);
+    ends = (const int32_t*)(data + layout.ends);
+    edgeColors = (const int32_t*)(data + layout.colors);
+
+    // structure checks, so that a corrupted file cannot break the graph
+    if(slotOffsets[0] != 0 || slotOffsets[n] != 2 * m) {
+        return;
+    }
+    for(uint64_t e = 0; e < m; e++) {
+        const int32_t a = ends[2*e], b = ends[2*e+1];
+        if(a < 0 || b < 0 || (uint64_t)a >= n || (uint64_t)b >= n || a == b || edgeColors[e] < 0) {
+            return;
+        }
+    }
+    // vertex ids and endpoint pairs must not repeat, the graph keeps one of each
+    if(header->flags & BINARY_GRAPH_SORTED) {
+        for(uint64_t v = 1; v < n; v++) {
+            if(ids[v-1] >= ids[v]) {
+                return;
+            }
+        }
+        for(uint64_t e = 1; e < m; e++) {
+            const auto previous = std::minmax(ends[2*e-2], ends[2*e-1]);
+            const auto current = std::minmax(ends[2*e], ends[2*e+1]);
+            if(!(previous < current)) {
+                return;
+            }
+        }
+    } else if(!isSimple()) {
+        return;
+    }
+    // every edge must occupy exactly one slot at each endpoint
+    std::vector<char> seen(2 * m, 0);
+    for(uint64_t v = 0; v < n; v++) {
+        if(slotOffsets[v+1] < slotOffsets[v] || slotOffsets[v+1] > 2 * m) {
+            return;
+        }
+        for(uint64_t s = slotOffsets[v]; s < slotOffsets[v+1]; s++) {
+            const int32_t e = edges[s];
+            if(e < 0 || (uint64_t)e >= m) {
+                return;
+            }
+            int side;
+            if((uint64_t)ends[2*e] == v && ends[2*e+1] == slotNeighbours[s]) {
+                side = 0;
+            } else if((uint64_t)ends[2*e+1] == v && ends[2*e] == slotNeighbours[s]) {
+                side = 1;
+            } else {
+                return;
+            }
+            if(seen[2*e + side]) {
+                return;
+            }
+            seen[2*e + side] = 1;
+        }
+    }
+    valid = true;
+}
+
+bool BinaryGraphView::isSimple() const {
+    const uint64_t n = header->numVertices, m = header->numEdges;
+    std::vector<int32_t> sortedIds(ids, ids + n);
+    std::sort(sortedIds.begin(), sortedIds.end());
+    if(std::adjacent_find(sortedIds.begin(), sortedIds.end()) != sortedIds.end()) {
+        return false;
+    }
+    std::vector<std::pair<int32_t, int32_t> > pairs;
+    pairs.reserve(m);
+    for(uint64_t e = 0; e < m; e++) {
+        pairs.emplace_back(std::minmax(ends[2*e], ends[2*e+1]));
+    }
+    std::sort(pairs.begin(), pairs.end());
+    return std::adjacent_find(pairs.begin(), pairs.end()) == pairs.end();
+}
+
+bool writeBinaryGraph(const CsrGraph& graph, const std::string& fileName) {
+    // renumber present vertices by id and live edges by endpoints, so that
+    // readers check them in one pass
+    std::vector<int> vertices;
+    vertices.reserve(graph.numVertices());
+    for(int v = 0; v < graph.vertexCapacity(); v++) {
+        if(graph.isPresent(v)) {
+            vertices.emplace_back(v);
+        }
+    }
+    std::sort(vertices.begin(), vertices.end(), [&](const int a, const int b) {
+        return graph.idOf(a) < graph.idOf(b);
+    });
+    std::vector<int32_t> newVertex(graph.vertexCapacity(), -1), newEdge(graph.edgeCapacity(), -1);
+    std::vector<int32_t> vertexIds;
+    vertexIds.reserve(vertices.size());
+    for(const int v : vertices) {
+        newVertex[v] = (int32_t)vertexIds.size();
+        vertexIds.emplace_back(graph.idOf(v));
+    }
+    std::vector<std::pair<std::pair<int32_t, int32_t>, int> > liveEdges;
+    liveEdges.reserve(graph.numEdges());
+    for(int e = 0; e < graph.edgeCapacity(); e++) {
+        if(graph.isEdge(e)) {
+            liveEdges.emplace_back(std::minmax(newVertex[graph.endpoints(e).first],
+                newVertex[graph.endpoints(e).second]), e);
+        }
+    }
+    std::sort(liveEdges.begin(), liveEdges.end());
+    std::vector<int32_t> ends, colors;
+    ends.reserve(2 * liveEdges.size());
+    colors.reserve(liveEdges.size());
+    for(const auto& live : liveEdges) {
+        const int e = live.second;
+        newEdge[e] = (int32_t)colors.size();
+        ends.emplace_back(newVertex[graph.endpoints(e).first]);
+        ends.emplace_back(newVertex[graph.endpoints(e).second]);
+        colors.emplace_back(graph.edge(e).color);
+    }
+    std::vector<uint64_t> offsets{0};
+    std::vector<int32_t> neighbours, slotEdges;
+    offsets.reserve(vertexIds.size() + 1);
+    neighbours.reserve(ends.size());
+    slotEdges.reserve(ends.size());
+    for(const int v : vertices) {
+        for(int i = 0; i < graph.degree(v); i++) {
+            neighbours.emplace_back(newVertex[graph.neighbour(v, i)]);
+            slotEdges.emplace_back(newEdge[graph.edgeAt(v, i)]);
+        }
+        offsets.emplace_back(neighbours.size());
+    }
+
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    if(!file) {
+        return false;
+    }
+    BinaryGraphHeader header;
+    memcpy(header.magic, BINARY_GRAPH_MAGIC, sizeof(header.magic));
+    header.version = BINARY_GRAPH_VERSION;
+    header.flags = BINARY_GRAPH_SORTED;
+    header.numVertices = vertexIds.size();
+    header.numEdges = colors.size();
+    if(!hostIsLittleEndian()) {
+        header.version = byteSwapped(header.version);
+        header.flags = byteSwapped(header.flags);
+        header.numVertices = byteSwapped(header.numVertices);
+        header.numEdges = byteSwapped(header.numEdges);
+    }
+    file.write((const char*)&header, sizeof(header));
+    writeSection(file, vertexIds);
+    writeSection(file, offsets);
+    writeSection(file, neighbours);
+    writeSection(file, slotEdges);
+    writeSection(file, ends);
+    writeSection(file, colors);
+    return (bool)file;
+}
+
+void readBinaryGraph(const BinaryGraphView& view, CsrGraph& graph) {
+    graph.assign((int)view.numVertices(), view.vertexIds(), view.offsets(), view.neighbours(),
+        view.slotEdges(), (int)view.numEdges(), view.edgeEnds());
+}
@@ -0,0 +1,82 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include "../include/block_decomposition.h"
+
+#include <algorithm>
+
+void BlockDecomposition::build(const CsrGraph& graph) {
+    blockEdges.clear();
+    blockOffsets.assign(1, 0);
+
+    const int n = graph.vertexCapacity();
+    cut.assign(n, 0);
+    nextSlot.assign(n, 0);
+    discovered.assign(n, -1);
+    low.assign(n, 0);
+    stack.clear();
+    edgeStack.clear();
+    time = 0;
+
+    for(int v = 0; v < n; v++) {
+        if(graph.isPresent(v) && discovered[v] == -1) {
+            search(graph, v);
+        }
+    }
+}
+
+void BlockDecomposition::search(const CsrGraph& graph, const int root) {
+    discovered[root] = low[root] = time++;
+    stack.push_back(Frame{root, -1});
+    int rootChildren = 0;
+    while(!stack.empty()) {
+        const Frame top = stack.back();
+        const int v = top.v;
+        if(nextSlot[v] < graph.degree(v)) {
+            const int slot = nextSlot[v]++;
+            const int e = graph.edgeAt(v, slot);
+            const int w = graph.neighbour(v, slot);
+            if(e == top.parentEdge) {
+                continue;
+            }
+            if(discovered[w] == -1) {
+                discovered[w] = low[w] = time++;
+                edgeStack.emplace_back(e);
+                stack.push_back(Frame{w, e});
+                if(v == root) {
+                    rootChildren++;
+                }
+            } else if(discovered[w] < discovered[v]) {
+                // back edge
+                edgeStack.emplace_back(e);
+                low[v] = std::min(low[v], discovered[w]);
+            }
+            continue;
+        }
+
+        stack.pop_back();
+        if(stack.empty()) {
+            break;
+        }
+        const int parent = stack.back().v;
+        low[parent] = std::min(low[parent], low[v]);
+        if(low[v] >= discovered[parent]) {
+            // parent separates subtree of v: edges above the tree edge form a block
+            if(parent != root) {
+                cut[parent] = 1;
+            }
+            int e;
+            do {
+                e = edgeStack.back();
+                edgeStack.pop_back();
+                blockEdges.emplace_back(e);
+            } while(e != top.parentEdge);
+            blockOffsets.emplace_back(blockEdges.size());
+        }
+    }
+    if(rootChildren > 1) {
+        cut[root] = 1;
+    }
+}
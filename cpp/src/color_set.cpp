@@ -0,0 +1,130 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include "../include/color_set.h"
+
+#include <algorithm>
+
+bool ColorSet::insert(const int color) {
+    if(isWide()) {
+        const auto it = std::lower_bound(wide.begin(), wide.end(), color);
+        if(it != wide.end() && *it == color) {
+            return false;
+        }
+        wide.insert(it, color);
+        numColors++;
+        return true;
+    }
+    if(numColors == 0) {
+        base = color;
+    } else if(color < base) {
+        if(highest() - color >= WINDOW) {
+            spill();
+            return insert(color);
+        }
+        rebase(color);
+    } else if(color - base >= WINDOW) {
+        spill();
+        return insert(color);
+    }
+    const int offset = color - base;
+    const uint64_t bit = 1ULL << (offset & 63);
+    if(bits[offset >> 6] & bit) {
+        return false;
+    }
+    bits[offset >> 6] |= bit;
+    numColors++;
+    return true;
+}
+
+bool ColorSet::contains(const int color) const {
+    if(isWide()) {
+        return std::binary_search(wide.begin(), wide.end(), color);
+    }
+    const int offset = color - base;
+    return numColors > 0 && offset >= 0 && offset < WINDOW
+        && (bits[offset >> 6] >> (offset & 63) & 1);
+}
+
+int ColorSet::lowest() const {
+    if(isWide()) {
+        return wide.front();
+    }
+    // window always starts at the lowest color
+    return numColors == 0 ? -1 : base;
+}
+
+int ColorSet::highest() const {
+    if(isWide()) {
+        return wide.back();
+    }
+    if(bits[1]) {
+        return base + 127 - __builtin_clzll(bits[1]);
+    }
+    return bits[0] ? base + 63 - __builtin_clzll(bits[0]) : -1;
+}
+
+int ColorSet::next(const int color) const {
+    if(isWide()) {
+        const auto it = std::lower_bound(wide.begin(), wide.end(), color);
+        return it == wide.end() ? -1 : *it;
+    }
+    if(numColors == 0) {
+        return -1;
+    }
+    int offset = std::max(0, color - base);
+    while(offset < WINDOW) {
+        const uint64_t word = bits[offset >> 6] >> (offset & 63);
+        if(word) {
+            return base + offset + __builtin_ctzll(word);
+        }
+        offset = (offset | 63) + 1;
+    }
+    return -1;
+}
+
+int ColorSet::firstGap() const {
+    if(!hasGaps()) {
+        return -1;
+    }
+    if(isWide()) {
+        for(size_t i = 1; i < wide.size(); i++) {
+            if(wide[i] != wide[i-1] + 1) {
+                return wide[i-1] + 1;
+            }
+        }
+        return -1;
+    }
+    // lowest color is bit 0, so the gap is the first zero bit
+    if(~bits[0]) {
+        return base + __builtin_ctzll(~bits[0]);
+    }
+    return base + 64 + __builtin_ctzll(~bits[1]);
+}
+
+std::vector<int> ColorSet::toVector() const {
+    std::vector<int> result;
+    result.reserve(numColors);
+    forEach([&result](const int c) { result.emplace_back(c); });
+    return result;
+}
+
+void ColorSet::rebase(const int newBase) {
+    const int shift = base - newBase;
+    if(shift >= 64) {
+        bits[1] = bits[0] << (shift - 64);
+        bits[0] = 0;
+    } else if(shift > 0) {
+        bits[1] = bits[1] << shift | bits[0] >> (64 - shift);
+        bits[0] <<= shift;
+    }
+    base = newBase;
+}
+
+void ColorSet::spill() {
+    std::vector<int> colors = toVector();
+    bits[0] = bits[1] = 0;
+    wide.swap(colors);
+}
@@ -0,0 +1,269 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include "../include/component_coloring.h"
+#include "../include/thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <deque>
+#include <map>
+#include <memory>
+#include <numeric>
+
+namespace {
+
+Graph emptyGraph() {
+    AdjList a;
+    return Graph(a);
+}
+
+/**
+ * Graph colored by one task of the pool.
+ */
+struct Job {
+    explicit Job(Graph g) : graph(std::move(g)), out(emptyGraph()) {}
+    Graph graph;
+    Graph out;
+    SolverStats stats;
+    SolverConfig config;
+    bool success = false;
+};
+
+/**
+ * Color every job on the pool, or on this thread if there is no pool.
+ */
+void run(ThreadPool* pool, const std::vector<Job*>& jobs, const bool countStats) {
+    for(Job* job : jobs) {
+        const auto color = [job, countStats] {
+            if(countStats) {
+                job->graph.setStats(&job->stats);
+            }
+            job->graph.setConfig(&job->config);
+            job->success = job->graph.color(job->out);
+        };
+        if(pool) {
+            pool->submit(color);
+        } else {
+            color();
+        }
+    }
+    if(pool) {
+        pool->wait();
+    }
+}
+
+bool allColored(const std::vector<Job*>& jobs) {
+    for(const Job* job : jobs) {
+        if(!job->success) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Give every job its own copy of config, seeded differently unless the
+ * seed is 0, so that jobs on different threads do not share a generator.
+ */
+void configure(std::deque<Job>& jobs, const SolverConfig* config) {
+    if(!config) {
+        return;
+    }
+    for(size_t k = 0; k < jobs.size(); k++) {
+        jobs[k].config = *config;
+        jobs[k].config.reseed(config->seed == 0 ? 0 : config->seed + 7919 * (unsigned)k);
+    }
+}
+
+/**
+ * Lowest and highest color at every vertex of a colored block.
+ */
+std::map<int, std::pair<int, int> > colorRanges(const Graph& block) {
+    std::map<int, std::pair<int, int> > ranges;
+    for(const auto& kv : block.getAdj()) {
+        auto& range = ranges[kv.first];
+        range = std::make_pair(INT_MAX, INT_MIN);
+        for(const auto& e : kv.second) {
+            range.first = std::min(range.first, e.color);
+            range.second = std::max(range.second, e.color);
+        }
+    }
+    return ranges;
+}
+
+/**
+ * Join colored blocks of one component into outGraph. Walking the block-cut
+ * tree from the first block, the palette of each block is shifted so that at
+ * the cut vertex it was reached through its colors directly follow colors
+ * already placed there. Shifting keeps every block consecutive colored, so
+ * every vertex stays consecutive colored. Finally all colors are shifted to
+ * start at 1.
+ */
+void reconcileBlocks(const std::vector<Job*>& blocks, Graph& outGraph) {
+    std::vector<std::map<int, std::pair<int, int> > > ranges;
+    std::map<int, std::vector<int> > blocksOf;
+    for(size_t b = 0; b < blocks.size(); b++) {
+        ranges.emplace_back(colorRanges(blocks[b]->out));
+        for(const auto& kv : ranges.back()) {
+            blocksOf[kv.first].emplace_back((int)b);
+        }
+    }
+
+    std::vector<int> shift(blocks.size(), 0);
+    std::vector<char> placed(blocks.size(), 0);
+    std::map<int, bool> cutDone;
+    std::deque<int> queue;
+    for(size_t root = 0; root < blocks.size(); root++) {
+        if(placed[root]) {
+            continue;
+        }
+        placed[root] = 1;
+        queue.push_back((int)root);
+        while(!queue.empty()) {
+            const int b = queue.front();
+            queue.pop_front();
+            for(const auto& kv : ranges[b]) {
+                const auto& owners = blocksOf[kv.first];
+                if(owners.size() < 2 || cutDone[kv.first]) {
+                    continue;
+                }
+                cutDone[kv.first] = true;
+                int highest = kv.second.second + shift[b];
+                for(const int other : owners) {
+                    if(placed[other]) {
+                        continue;
+                    }
+                    const auto& range = ranges[other].at(kv.first);
+                    shift[other] = highest + 1 - range.first;
+                    highest += range.second - range.first + 1;
+                    placed[other] = 1;
+                    queue.push_back(other);
+                }
+            }
+        }
+    }
+
+    int lowest = INT_MAX;
+    for(size_t b = 0; b < blocks.size(); b++) {
+        for(const auto& kv : ranges[b]) {
+            lowest = std::min(lowest, kv.second.first + shift[b]);
+        }
+    }
+    for(size_t b = 0; b < blocks.size(); b++) {
+        for(const auto& kv : blocks[b]->out.getAdj()) {
+            for(const auto& e : kv.second) {
+                if(e.v1 < e.v2) {
+                    outGraph.addEdge(Edge(e.v1, e.v2, e.color + shift[b] + 1 - lowest));
+                }
+            }
+        }
+    }
+}
+
+}
+
+bool colorComponents(Graph& graph, Graph& outGraph, unsigned numThreads, SolverStats* stats,
+    const SolverConfig* config) {
+
+    const auto start = std::chrono::steady_clock::now();
+    const int numVertices = graph.numVertices(), numEdges = graph.numEdges();
+    std::vector<Graph> components = graph.splitComponents();
+    graph = emptyGraph();
+    LOG_DEBUG("Coloring " << components.size() << " components");
+
+    // largest first, so that the pool does not end with one long task
+    std::vector<size_t> order(components.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](const size_t a, const size_t b) {
+        return components[a].numEdges() > components[b].numEdges();
+    });
+
+    // uncolored components with more than one block are colored block by block
+    std::deque<Job> jobs;
+    std::vector<std::vector<Job*> > blockJobs(components.size());
+    std::vector<Job*> wholeJobs(components.size(), nullptr);
+    std::vector<Job*> queued;
+    for(const size_t i : order) {
+        std::vector<Graph> blocks;
+        if(components[i].isUncolored()) {
+            blocks = components[i].splitBlocks();
+        }
+        if(blocks.size() > 1) {
+            LOG_DEBUG("Component " << i << " has " << blocks.size() << " blocks");
+            for(auto& block : blocks) {
+                jobs.emplace_back(std::move(block));
+                blockJobs[i].emplace_back(&jobs.back());
+                queued.emplace_back(&jobs.back());
+            }
+        } else {
+            jobs.emplace_back(std::move(components[i]));
+            wholeJobs[i] = &jobs.back();
+            queued.emplace_back(&jobs.back());
+        }
+    }
+
+    configure(jobs, config);
+    std::stable_sort(queued.begin(), queued.end(), [](const Job* a, const Job* b) {
+        return a->graph.numEdges() > b->graph.numEdges();
+    });
+    // a single worker would only cost starting its thread
+    std::unique_ptr<ThreadPool> pool;
+    if(numThreads != 1) {
+        pool.reset(new ThreadPool(numThreads));
+    }
+    run(pool.get(), queued, stats != nullptr);
+
+    // a component whose blocks cannot be colored separately may still be
+    // colorable as a whole, when colors of its blocks interleave at cut vertices
+    queued.clear();
+    for(size_t i = 0; i < components.size(); i++) {
+        if(blockJobs[i].empty()) {
+            continue;
+        }
+        if(!allColored(blockJobs[i]) && !(config && config->isCancelled())) {
+            LOG_DEBUG("Blocks of component " << i << " failed, coloring it as a whole");
+            jobs.emplace_back(std::move(components[i]));
+            wholeJobs[i] = &jobs.back();
+            queued.emplace_back(&jobs.back());
+        }
+    }
+    configure(jobs, config);
+    run(pool.get(), queued, stats != nullptr);
+
+    // merge in component order, so that output does not depend on scheduling
+    bool result = true;
+    for(size_t i = 0; i < components.size(); i++) {
+        if(wholeJobs[i]) {
+            result = result && wholeJobs[i]->success;
+            wholeJobs[i]->out.moveAllEdgesToAnotherGraph(outGraph);
+            wholeJobs[i]->graph.moveAllEdgesToAnotherGraph(graph);
+        } else {
+            if(allColored(blockJobs[i])) {
+                reconcileBlocks(blockJobs[i], outGraph);
+                continue;
+            }
+            // cancelled before the component was retried as a whole
+            result = false;
+            for(Job* job : blockJobs[i]) {
+                job->out.moveAllEdgesToAnotherGraph(graph);
+                job->graph.moveAllEdgesToAnotherGraph(graph);
+            }
+        }
+    }
+    if(stats) {
+        *stats = SolverStats();
+        for(const auto& job : jobs) {
+            stats->add(job.stats);
+        }
+        stats->vertices = numVertices;
+        stats->edges = numEdges;
+        stats->success = result;
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        stats->totalTime = elapsed.count();
+    }
+    return result;
+}
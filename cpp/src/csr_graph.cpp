@@ -0,0 +1,312 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include "../include/csr_graph.h"
+
+#include <algorithm>
+#include <initializer_list>
+
+int CsrGraph::addVertex(const int id) {
+    const int v = internVertex(id);
+    if(!present[v]) {
+        present[v] = 1;
+        numPresent++;
+    }
+    return v;
+}
+
+int CsrGraph::internVertex(const int id) {
+    int v = indexOf(id);
+    if(v == -1) {
+        v = (int)ids.size();
+        ids.emplace_back(id);
+        present.emplace_back(0);
+        blocks.push_back(Block{(int)slotNeighbour.size(), 0, 0});
+        if(id >= 0 && id < DIRECT_ID_LIMIT) {
+            if((int)directIndex.size() <= id) {
+                directIndex.resize(std::max<size_t>(id + 1, directIndex.size() * 2), -1);
+            }
+            directIndex[id] = v;
+        } else {
+            sparseIndex[id] = v;
+        }
+    }
+    return v;
+}
+
+int CsrGraph::indexOf(const int id) const {
+    if(id >= 0 && id < DIRECT_ID_LIMIT) {
+        return id < (int)directIndex.size() ? directIndex[id] : -1;
+    }
+    const auto it = sparseIndex.find(id);
+    return it == sparseIndex.end() ? -1 : it->second;
+}
+
+void CsrGraph::ensureSlot(const int v) {
+    Block& block = blocks[v];
+    if(block.degree < block.capacity) {
+        return;
+    }
+    const int newCapacity = std::max(4, block.capacity * 2);
+    if(block.start + block.capacity == (int)slotNeighbour.size()) {
+        // block is at the end of the array, just extend it
+        slotNeighbour.resize(block.start + newCapacity, -1);
+        slotEdge.resize(block.start + newCapacity, -1);
+    } else {
+        if(deadSlots + block.capacity > slotNeighbour.size() / 2 && slotNeighbour.size() > 64) {
+            compact();
+            ensureSlot(v);
+            return;
+        }
+        const int newStart = (int)slotNeighbour.size();
+        slotNeighbour.resize(newStart + newCapacity, -1);
+        slotEdge.resize(newStart + newCapacity, -1);
+        std::copy(slotNeighbour.begin() + block.start,
+            slotNeighbour.begin() + block.start + block.degree, slotNeighbour.begin() + newStart);
+        std::copy(slotEdge.begin() + block.start,
+            slotEdge.begin() + block.start + block.degree, slotEdge.begin() + newStart);
+        deadSlots += block.capacity;
+        block.start = newStart;
+    }
+    block.capacity = newCapacity;
+}
+
+void CsrGraph::compact() {
+    std::vector<int> newNeighbour, newEdge;
+    size_t total = 0;
+    for(const Block& b : blocks) {
+        total += std::max(b.degree + 1, b.degree * 5 / 4);
+    }
+    newNeighbour.reserve(total);
+    newEdge.reserve(total);
+    for(Block& b : blocks) {
+        const int newStart = (int)newNeighbour.size();
+        const int newCapacity = b.degree == 0 ? 0 : std::max(b.degree + 1, b.degree * 5 / 4);
+        newNeighbour.insert(newNeighbour.end(), slotNeighbour.begin() + b.start,
+            slotNeighbour.begin() + b.start + b.degree);
+        newEdge.insert(newEdge.end(), slotEdge.begin() + b.start,
+            slotEdge.begin() + b.start + b.degree);
+        newNeighbour.resize(newStart + newCapacity, -1);
+        newEdge.resize(newStart + newCapacity, -1);
+        b.start = newStart;
+        b.capacity = newCapacity;
+    }
+    slotNeighbour.swap(newNeighbour);
+    slotEdge.swap(newEdge);
+    deadSlots = 0;
+}
+
+int CsrGraph::addEdge(const int a, const int b, const int color) {
+    const int existing = findEdge(a, b);
+    if(existing != -1) {
+        return existing;
+    }
+    const int e = (int)edgeEnds.size();
+    edgeEnds.emplace_back(a, b);
+    edgeSlots.emplace_back(-1, -1);
+    records.emplace_back(ids[a], ids[b], color);
+    parked.emplace_back(0);
+    index.insert(std::min(a, b), std::max(a, b), e);
+    linkSlots(e);
+    return e;
+}
+
+void CsrGraph::linkSlots(const int e) {
+    const int a = edgeEnds[e].first, b = edgeEnds[e].second;
+    ensureSlot(a);
+    ensureSlot(b);
+    Block& ba = blocks[a];
+    slotNeighbour[ba.start + ba.degree] = b;
+    slotEdge[ba.start + ba.degree] = e;
+    edgeSlots[e].first = ba.degree++;
+    Block& bb = blocks[b];
+    slotNeighbour[bb.start + bb.degree] = a;
+    slotEdge[bb.start + bb.degree] = e;
+    edgeSlots[e].second = bb.degree++;
+
+    for(const int v : {a, b}) {
+        if(!present[v]) {
+            present[v] = 1;
+            numPresent++;
+        }
+    }
+    numLive++;
+}
+
+void CsrGraph::removeEdge(const int e) {
+    const int a = edgeEnds[e].first, b = edgeEnds[e].second;
+    unlinkSlots(e);
+    index.erase(std::min(a, b), std::max(a, b));
+    edgeEnds[e] = std::make_pair(-1, -1);
+    records[e].color = 0;
+}
+
+void CsrGraph::parkEdge(const int e) {
+    const int a = edgeEnds[e].first, b = edgeEnds[e].second;
+    unlinkSlots(e);
+    index.erase(std::min(a, b), std::max(a, b));
+    parked[e] = 1;
+}
+
+void CsrGraph::restoreEdge(const int e) {
+    const int a = edgeEnds[e].first, b = edgeEnds[e].second;
+    parked[e] = 0;
+    index.insert(std::min(a, b), std::max(a, b), e);
+    linkSlots(e);
+}
+
+void CsrGraph::unlinkSlots(const int e) {
+    const int a = edgeEnds[e].first, b = edgeEnds[e].second;
+    for(const int v : {a, b}) {
+        // swap with last slot of the block
+        Block& block = blocks[v];
+        const int slot = slotOf(e, v), last = block.degree - 1;
+        if(slot != last) {
+            const int movedEdge = slotEdge[block.start + last];
+            slotNeighbour[block.start + slot] = slotNeighbour[block.start + last];
+            slotEdge[block.start + slot] = movedEdge;
+            setSlotOf(movedEdge, v, slot);
+        }
+        block.degree--;
+        if(block.degree == 0 && present[v]) {
+            present[v] = 0;
+            numPresent--;
+        }
+    }
+    numLive--;
+}
+
+void CsrGraph::clear() {
+    ids.clear();
+    std::fill(directIndex.begin(), directIndex.end(), -1);
+    sparseIndex.clear();
+    present.clear();
+    blocks.clear();
+    slotNeighbour.clear();
+    slotEdge.clear();
+    deadSlots = 0;
+    edgeEnds.clear();
+    edgeSlots.clear();
+    records.clear();
+    parked.clear();
+    index.clear();
+    numPresent = 0;
+    numLive = 0;
+}
+
+void CsrGraph::build(const std::vector<int>& rowIds, const std::vector<size_t>& rowOffsets,
+    const std::vector<int>& neighbourIds) {
+
+    clear();
+
+    for(const int id : rowIds) {
+        addVertex(id);
+    }
+    for(const int id : neighbourIds) {
+        addVertex(id);
+    }
+    const int n = (int)ids.size();
+    index.reserve(neighbourIds.size() / 2 + 1);
+
+    // first pass: create edges in order of appearance and count block sizes
+    std::vector<int> rowEdges(neighbourIds.size(), -1);
+    std::vector<int> sizes(n, 0);
+    for(size_t r = 0; r < rowIds.size(); r++) {
+        const int u = indexOf(rowIds[r]);
+        for(size_t i = rowOffsets[r]; i < rowOffsets[r+1]; i++) {
+            const int w = indexOf(neighbourIds[i]);
+            if(u == w) {
+                continue;
+            }
+            int e = findEdge(u, w);
+            if(e == -1) {
+                e = (int)edgeEnds.size();
+                edgeEnds.emplace_back(u, w);
+                edgeSlots.emplace_back(-1, -1);
+                records.emplace_back(ids[u], ids[w], 0);
+                parked.emplace_back(0);
+                index.insert(std::min(u, w), std::max(u, w), e);
+                numLive++;
+                sizes[u]++;
+                sizes[w]++;
+            }
+            rowEdges[i] = e;
+        }
+    }
+
+    size_t total = 0;
+    for(int v = 0; v < n; v++) {
+        blocks[v] = Block{(int)total, 0, sizes[v]};
+        total += sizes[v];
+    }
+    slotNeighbour.assign(total, -1);
+    slotEdge.assign(total, -1);
+
+    const auto place = [this](const int v, const int e) {
+        Block& block = blocks[v];
+        slotNeighbour[block.start + block.degree] = other(e, v);
+        slotEdge[block.start + block.degree] = e;
+        setSlotOf(e, v, block.degree++);
+    };
+
+    // second pass: each vertex lists its own row first
+    for(size_t r = 0; r < rowIds.size(); r++) {
+        const int u = indexOf(rowIds[r]);
+        for(size_t i = rowOffsets[r]; i < rowOffsets[r+1]; i++) {
+            const int e = rowEdges[i];
+            if(e != -1 && slotOf(e, u) == -1) {
+                place(u, e);
+            }
+        }
+    }
+    // edges that were listed only by one endpoint
+    for(int e = 0; e < (int)edgeEnds.size(); e++) {
+        if(edgeSlots[e].first == -1) {
+            place(edgeEnds[e].first, e);
+        }
+        if(edgeSlots[e].second == -1) {
+            place(edgeEnds[e].second, e);
+        }
+    }
+}
+
+void CsrGraph::assign(const int n, const int32_t* vertexIds, const uint64_t* offsets,
+    const int32_t* neighbours, const int32_t* slotEdges, const int m, const int32_t* ends) {
+
+    clear();
+
+    ids.reserve(n);
+    present.reserve(n);
+    blocks.reserve(n);
+    for(int v = 0; v < n; v++) {
+        internVertex(vertexIds[v]);
+        blocks[v] = Block{(int)offsets[v], (int)(offsets[v+1] - offsets[v]),
+            (int)(offsets[v+1] - offsets[v])};
+    }
+    present.assign(n, 1);
+    numPresent = n;
+
+    slotNeighbour.assign(neighbours, neighbours + offsets[n]);
+    slotEdge.assign(slotEdges, slotEdges + offsets[n]);
+
+    edgeEnds.reserve(m);
+    edgeSlots.assign(m, std::make_pair(-1, -1));
+    records.reserve(m);
+    parked.assign(m, 0);
+    index.reserve(m);
+    for(int e = 0; e < m; e++) {
+        const int a = ends[2*e], b = ends[2*e+1];
+        edgeEnds.emplace_back(a, b);
+        records.emplace_back(ids[a], ids[b], 0);
+        index.insert(std::min(a, b), std::max(a, b), e);
+    }
+    numLive = m;
+
+    for(int v = 0; v < n; v++) {
+        for(int i = 0; i < blocks[v].degree; i++) {
+            setSlotOf(slotEdge[blocks[v].start + i], v, i);
+        }
+    }
+}
@@ -0,0 +1,197 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include "../include/cycle_decomposition.h"
+
+void CycleDecomposition::build(const CsrGraph& graph, const int start) {
+    cycleVertices.clear();
+    cycleEdges.clear();
+    cycleOffsets.assign(1, 0);
+    nextCycle = 0;
+    prioritized = false;
+    queue = std::priority_queue<Entry>();
+
+    const int n = graph.vertexCapacity();
+    nextSlot.assign(n, 0);
+    stackPos.assign(n, -1);
+    visited.assign(n, 0);
+    used.assign(graph.edgeCapacity(), 0);
+    stack.clear();
+
+    // released vertices are appended to roots and searched again
+    roots.clear();
+    if(start != -1) {
+        roots.emplace_back(start);
+    }
+    for(int v = 0; v < n; v++) {
+        if(graph.isPresent(v)) {
+            roots.emplace_back(v);
+        }
+    }
+    for(size_t r = 0; r < roots.size(); r++) {
+        if(!visited[roots[r]]) {
+            search(graph, roots[r]);
+        }
+    }
+}
+
+void CycleDecomposition::search(const CsrGraph& graph, const int root) {
+    visited[root] = 1;
+    stackPos[root] = 0;
+    stack.push_back(Frame{root, -1});
+    while(!stack.empty()) {
+        const Frame top = stack.back();
+        const int v = top.v;
+        if(nextSlot[v] == graph.degree(v)) {
+            stackPos[v] = -1;
+            stack.pop_back();
+            continue;
+        }
+        const int slot = nextSlot[v]++;
+        const int e = graph.edgeAt(v, slot);
+        if(used[e] || e == top.parentEdge) {
+            continue;
+        }
+        const int w = graph.neighbour(v, slot);
+        if(stackPos[w] != -1) {
+            emitCycle(stackPos[w], e);
+        } else if(!visited[w]) {
+            visited[w] = 1;
+            stackPos[w] = (int)stack.size();
+            stack.push_back(Frame{w, e});
+        }
+    }
+}
+
+void CycleDecomposition::emitCycle(const int from, const int closingEdge) {
+    for(size_t k = from; k < stack.size(); k++) {
+        cycleVertices.emplace_back(stack[k].v);
+        if(k > (size_t)from) {
+            cycleEdges.emplace_back(stack[k].parentEdge);
+            used[stack[k].parentEdge] = 1;
+        }
+    }
+    cycleVertices.emplace_back(stack[from].v);
+    cycleEdges.emplace_back(closingEdge);
+    used[closingEdge] = 1;
+    // keep both arrays aligned: one edge per vertex except the repeated last one
+    cycleEdges.emplace_back(-1);
+    cycleOffsets.emplace_back(cycleVertices.size());
+
+    // release vertices above the closing vertex
+    while((int)stack.size() > from + 1) {
+        const int v = stack.back().v;
+        stackPos[v] = -1;
+        visited[v] = 0;
+        roots.emplace_back(v);
+        stack.pop_back();
+    }
+}
+
+bool CycleDecomposition::next(const CsrGraph& graph, std::vector<int>& vertices) {
+    int found = -1;
+    if(prioritized) {
+        while(!queue.empty() && found == -1) {
+            const Entry top = queue.top();
+            queue.pop();
+            if(top.version != versions[top.cycle] || handedOut[top.cycle]) {
+                continue;
+            }
+            handedOut[top.cycle] = 1;
+            if(isIntact(graph, top.cycle)) {
+                found = top.cycle;
+            }
+        }
+    } else {
+        while(nextCycle + 1 < cycleOffsets.size() && found == -1) {
+            if(isIntact(graph, (int)nextCycle)) {
+                found = (int)nextCycle;
+            }
+            nextCycle++;
+        }
+    }
+    if(found == -1) {
+        return false;
+    }
+    vertices.assign(cycleVertices.begin() + cycleOffsets[found], cycleVertices.begin() + cycleOffsets[found + 1]);
+    return true;
+}
+
+bool CycleDecomposition::isIntact(const CsrGraph& graph, const int cycle) const {
+    for(size_t i = cycleOffsets[cycle]; i + 1 < cycleOffsets[cycle + 1]; i++) {
+        if(!graph.isEdge(cycleEdges[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void CycleDecomposition::prioritize(const std::function<long long(int)>& score, std::mt19937* rng) {
+    const int numVertices = (int)nextSlot.size();
+    cyclesOfOffsets.assign(numVertices + 1, 0);
+    for(int c = 0; c < numCycles(); c++) {
+        // the last vertex repeats the first one
+        for(size_t i = cycleOffsets[c]; i + 1 < cycleOffsets[c + 1]; i++) {
+            cyclesOfOffsets[cycleVertices[i] + 1]++;
+        }
+    }
+    for(int v = 0; v < numVertices; v++) {
+        cyclesOfOffsets[v + 1] += cyclesOfOffsets[v];
+    }
+    cyclesOf.resize(cyclesOfOffsets[numVertices]);
+    std::vector<size_t> fill(cyclesOfOffsets.begin(), cyclesOfOffsets.end() - 1);
+    for(int c = 0; c < numCycles(); c++) {
+        for(size_t i = cycleOffsets[c]; i + 1 < cycleOffsets[c + 1]; i++) {
+            cyclesOf[fill[cycleVertices[i]]++] = c;
+        }
+    }
+
+    versions.assign(numCycles(), 0);
+    ties.resize(numCycles());
+    for(int c = 0; c < numCycles(); c++) {
+        ties[c] = rng ? (unsigned)(*rng)() : (unsigned)c;
+    }
+    // cycles already handed out in order stay handed out
+    handedOut.assign(numCycles(), 0);
+    for(size_t c = 0; c < nextCycle && c < handedOut.size(); c++) {
+        handedOut[c] = 1;
+    }
+    queue = std::priority_queue<Entry>();
+    prioritized = true;
+    for(int c = 0; c < numCycles(); c++) {
+        enqueue(c, score);
+    }
+}
+
+void CycleDecomposition::reprioritize(const std::vector<int>& vertices,
+    const std::function<long long(int)>& score) {
+
+    if(!prioritized) {
+        return;
+    }
+    for(const int v : vertices) {
+        if(v < 0 || v + 1 >= (int)cyclesOfOffsets.size()) {
+            continue;
+        }
+        for(size_t i = cyclesOfOffsets[v]; i < cyclesOfOffsets[v + 1]; i++) {
+            const int c = cyclesOf[i];
+            if(!handedOut[c]) {
+                versions[c]++;
+                enqueue(c, score);
+            }
+        }
+    }
+}
+
+void CycleDecomposition::enqueue(const int cycle, const std::function<long long(int)>& score) {
+    // mean, so that long cycles do not win by length alone
+    long long priority = 0;
+    const size_t begin = cycleOffsets[cycle], end = cycleOffsets[cycle + 1] - 1;
+    for(size_t i = begin; i < end; i++) {
+        priority += score(cycleVertices[i]);
+    }
+    priority /= (long long)(end - begin);
+    queue.push(Entry{priority, ties[cycle], cycle, versions[cycle]});
+}
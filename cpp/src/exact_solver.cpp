@@ -0,0 +1,639 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include "../include/exact_solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <unordered_map>
+
+namespace {
+
+/**
+ * Nogoods longer than this are not worth checking.
+ */
+const size_t MAX_NOGOOD_SIZE = 8;
+const size_t MAX_NOGOODS = 1 << 16;
+/**
+ * Vertices of higher degree are not checked for an interval of their edges.
+ */
+const int MAX_MATCHED_DEGREE = 64;
+
+Graph emptyGraph() {
+    AdjList a;
+    return Graph(a);
+}
+
+/**
+ * Branch and bound search over one connected component.
+ */
+class Search {
+public:
+    Search(const Graph& component, const ExactLimits& limits,
+        const std::chrono::steady_clock::time_point start);
+
+    ExactResult run();
+    /**
+     * Add colored edges to outGraph with colors starting at 1.
+     */
+    void moveTo(Graph& outGraph) const;
+    long long nodes() const { return numNodes; }
+    long long nogoods() const { return (long long)nogoodLiterals.size(); }
+
+private:
+    /**
+     * Lowest and highest color in use and depths of edges that have them.
+     */
+    struct Bounds {
+        int lowest, highest;
+        int lowestDepth, highestDepth;
+    };
+    /**
+     * Edge colored at some depth of the search, colors left to try and
+     * depths of assignments that ruled out colors tried so far. Bounds and
+     * windows of both ends from before the assignment are kept to undo it.
+     */
+    struct Level {
+        int edge;
+        std::vector<int> values;
+        size_t next;
+        std::vector<int> conflict;
+        Bounds global;
+        std::pair<int, int> windows[2];
+    };
+
+    /**
+     * Range of colors edge e can take given the global bounds and the
+     * colors at its ends, empty if first > second.
+     */
+    std::pair<int, int> windowOf(const int e) const;
+    /**
+     * Colors edge e can take now. If reason is not null, depths of
+     * assignments that rule out other colors are added to it.
+     */
+    std::vector<int> domainOf(const int e, std::vector<int>* reason) const;
+    /**
+     * Number of colors edge e can take now, not counting nogoods.
+     */
+    int domainSize(const int e) const;
+    /**
+     * Check if uncolored edges at vertex w cannot take distinct colors that
+     * complete an interval of its degree with its colors. If so and reason is
+     * not null, depths of assignments that cause it are added to it.
+     */
+    bool hasNoInterval(const int w, std::vector<int>* reason);
+    /**
+     * Find augmenting path from the i-th uncolored edge in matching of edges
+     * to interval positions they allow, as in Kuhn's algorithm.
+     */
+    bool augment(const int i, uint64_t& visited);
+    bool isUsed(const int w, const int c) const {
+        return (usedColors[w * usedWords + c / 64] >> (c % 64)) & 1;
+    }
+    /**
+     * Check if a nogood forbids color c of edge e.
+     */
+    bool isForbidden(const int e, const int c, std::vector<int>* reason) const;
+    /**
+     * Order values so that colors close to colors at ends of e come first.
+     */
+    void orderValues(const int e, std::vector<int>& values) const;
+    /**
+     * Number of colored edges sharing a vertex with e.
+     */
+    int coloredNeighbours(const int e) const {
+        return numColored[ends[e].first] + numColored[ends[e].second];
+    }
+    /**
+     * Color edge e of the last level with c, updating bounds and windows.
+     */
+    void assign(const int e, const int c);
+    /**
+     * Uncolor edge of level, restoring bounds and windows from before.
+     */
+    void unassign(Level& level);
+    /**
+     * Undo levels up to the latest one in conflict and try its next color.
+     * Exhausted levels pass their conflict on and it is learned as nogood.
+     * Return false if no level is left, i.e. there is no coloring.
+     */
+    bool backjump(std::vector<int> conflict);
+    void learn(const std::vector<int>& conflict);
+    bool limitReached() const;
+
+    long long literalKey(const int e, const int c) const { return (long long)e * (maxColor + 1) + c; }
+
+    const ExactLimits& limits;
+    const std::chrono::steady_clock::time_point start;
+
+    std::vector<int> vertexIds;
+    std::vector<std::pair<int, int> > ends;
+    std::vector<std::vector<int> > incident;
+    std::vector<int> color;
+    std::vector<int> depthOf;
+    std::vector<Level> levels;
+    Bounds global;
+    /**
+     * Lowest and highest color and number of colored edges at every vertex,
+     * kept up to date on assignment and restored on backjump.
+     */
+    std::vector<int> low, high, numColored;
+    /**
+     * Colors in use at every vertex, usedWords words of bits each.
+     */
+    std::vector<uint64_t> usedColors;
+    int usedWords;
+    /**
+     * Buffers of hasNoInterval: uncolored edges, their windows, positions of
+     * the interval each allows and edge matched to every position.
+     */
+    std::vector<int> uncolored;
+    std::vector<std::pair<int, int> > windows;
+    std::vector<uint64_t> allowed;
+    std::vector<int> matchOf;
+    /**
+     * Colors of a coloring span at most span, with the first edge fixed to
+     * color span all of them are within [1, maxColor].
+     */
+    int span;
+    int maxColor;
+    /**
+     * Edge whose colors are limited to [1, span] to rule out reversed colorings, or -1.
+     */
+    int mirrored = -1;
+
+    std::vector<std::vector<std::pair<int, int> > > nogoodLiterals;
+    std::unordered_map<long long, std::vector<int> > nogoodsOf;
+    long long numNodes = 0;
+};
+
+Search::Search(const Graph& component, const ExactLimits& limits,
+    const std::chrono::steady_clock::time_point start) : limits(limits), start(start) {
+
+    std::map<int, int> local;
+    for(const auto& kv : component.getAdj()) {
+        local[kv.first] = (int)vertexIds.size();
+        vertexIds.emplace_back(kv.first);
+    }
+    incident.resize(vertexIds.size());
+    for(const auto& kv : component.getAdj()) {
+        for(const auto& e : kv.second) {
+            if(e.v1 < e.v2) {
+                const int a = local[e.v1], b = local[e.v2];
+                incident[a].emplace_back((int)ends.size());
+                incident[b].emplace_back((int)ends.size());
+                ends.emplace_back(a, b);
+            }
+        }
+    }
+    color.assign(ends.size(), 0);
+    depthOf.assign(ends.size(), -1);
+    const int n = (int)vertexIds.size();
+    span = std::max(1, 2 * n - 3);
+    maxColor = 2 * span - 1;
+
+    global = Bounds{INT_MAX, INT_MIN, -1, -1};
+    low.assign(n, INT_MAX);
+    high.assign(n, INT_MIN);
+    numColored.assign(n, 0);
+    usedWords = maxColor / 64 + 1;
+    usedColors.assign((size_t)n * usedWords, 0);
+}
+
+ExactResult Search::run() {
+    if(ends.empty()) {
+        return ExactResult::Colored;
+    }
+    if(limits.maxEdges > 0 && (int)ends.size() > limits.maxEdges) {
+        return ExactResult::LimitReached;
+    }
+    // a regular graph has an interval coloring only if its degree many colors
+    // suffice (Asratian and Kamalian), and matchings of odd order graphs miss
+    // a vertex each
+    bool regular = true;
+    for(size_t w = 1; w < incident.size(); w++) {
+        regular = regular && incident[w].size() == incident[0].size();
+    }
+    if(regular && incident.size() % 2 == 1) {
+        return ExactResult::Infeasible;
+    }
+
+    // shifting any coloring puts the most connected edge at color span
+    int first = 0;
+    for(int e = 1; e < (int)ends.size(); e++) {
+        if(incident[ends[e].first].size() + incident[ends[e].second].size()
+            > incident[ends[first].first].size() + incident[ends[first].second].size()) {
+            first = e;
+        }
+    }
+    levels.push_back(Level{first, std::vector<int>{span}, 1, std::vector<int>()});
+    assign(first, span);
+    // reversing colors around span maps colorings onto colorings, so an edge
+    // next to the first one may stay at or below span
+    for(const int e : incident[ends[first].first]) {
+        if(e != first) {
+            mirrored = e;
+            break;
+        }
+    }
+
+    std::vector<int> values, reason;
+    while(true) {
+        if(limitReached()) {
+            return ExactResult::LimitReached;
+        }
+        numNodes++;
+
+        int best = -1, wiped = -1;
+        size_t bestSize = 0;
+        int bestNeighbours = 0;
+        for(int e = 0; e < (int)ends.size() && wiped == -1; e++) {
+            if(color[e] != 0) {
+                continue;
+            }
+            const size_t size = domainSize(e);
+            const int neighbours = coloredNeighbours(e);
+            if(size == 0) {
+                wiped = e;
+            } else if(best == -1 || size < bestSize
+                || (size == bestSize && neighbours > bestNeighbours)) {
+                best = e;
+                bestSize = size;
+                bestNeighbours = neighbours;
+            }
+        }
+        reason.clear();
+        bool conflict = wiped != -1;
+        if(conflict) {
+            domainOf(wiped, &reason);
+        }
+        // edges of every vertex must still fit an interval
+        for(int w = 0; w < (int)vertexIds.size() && !conflict; w++) {
+            conflict = hasNoInterval(w, &reason);
+        }
+        // nogoods are checked only for the edge to color next
+        if(!conflict && best != -1) {
+            values = domainOf(best, &reason);
+            conflict = values.empty();
+        }
+
+        if(conflict) {
+            if(!backjump(reason)) {
+                return ExactResult::Infeasible;
+            }
+        } else if(best == -1) {
+            return ExactResult::Colored;
+        } else {
+            orderValues(best, values);
+            std::sort(reason.begin(), reason.end());
+            reason.erase(std::unique(reason.begin(), reason.end()), reason.end());
+            levels.push_back(Level{best, values, 1, reason});
+            assign(best, values[0]);
+        }
+    }
+}
+
+std::pair<int, int> Search::windowOf(const int e) const {
+    int lo = 1, hi = maxColor;
+    if(global.lowestDepth >= 0) {
+        lo = std::max(lo, global.highest - span + 1);
+        hi = std::min(hi, global.lowest + span - 1);
+    }
+    for(const int w : {ends[e].first, ends[e].second}) {
+        if(numColored[w] > 0) {
+            const int degree = (int)incident[w].size();
+            lo = std::max(lo, high[w] - degree + 1);
+            hi = std::min(hi, low[w] + degree - 1);
+        }
+    }
+    if(e == mirrored) {
+        hi = std::min(hi, span);
+    }
+    return std::make_pair(lo, hi);
+}
+
+std::vector<int> Search::domainOf(const int e, std::vector<int>* reason) const {
+    if(reason) {
+        if(global.lowestDepth >= 0) {
+            reason->emplace_back(global.lowestDepth);
+            reason->emplace_back(global.highestDepth);
+        }
+        for(const int w : {ends[e].first, ends[e].second}) {
+            for(const int f : incident[w]) {
+                if(color[f] != 0) {
+                    reason->emplace_back(depthOf[f]);
+                }
+            }
+        }
+    }
+
+    const std::pair<int, int> window = windowOf(e);
+    const int a = ends[e].first, b = ends[e].second;
+    std::vector<int> values;
+    for(int c = window.first; c <= window.second; c++) {
+        if(!isUsed(a, c) && !isUsed(b, c) && !isForbidden(e, c, reason)) {
+            values.emplace_back(c);
+        }
+    }
+    return values;
+}
+
+int Search::domainSize(const int e) const {
+    const std::pair<int, int> window = windowOf(e);
+    const int a = ends[e].first, b = ends[e].second;
+    int size = 0;
+    for(int c = window.first; c <= window.second; c++) {
+        size += !isUsed(a, c) && !isUsed(b, c);
+    }
+    return size;
+}
+
+bool Search::hasNoInterval(const int w, std::vector<int>* reason) {
+    const int degree = (int)incident[w].size();
+    if(numColored[w] == degree || degree > MAX_MATCHED_DEGREE) {
+        return false;
+    }
+    uncolored.clear();
+    windows.clear();
+    for(const int f : incident[w]) {
+        if(color[f] == 0) {
+            uncolored.emplace_back(f);
+            windows.emplace_back(windowOf(f));
+        }
+    }
+    // colors of w are [start, start + degree - 1] and cover those in use
+    int first = 1, last = maxColor - degree + 1;
+    if(global.lowestDepth >= 0) {
+        first = std::max(first, global.highest - span + 1);
+        last = std::min(last, global.lowest + span - degree);
+    }
+    if(numColored[w] > 0) {
+        first = std::max(first, high[w] - degree + 1);
+        last = std::min(last, low[w]);
+    }
+
+    allowed.resize(uncolored.size());
+    matchOf.resize(degree);
+    for(int start = first; start <= last; start++) {
+        for(size_t i = 0; i < uncolored.size(); i++) {
+            const int f = uncolored[i];
+            const int other = ends[f].first == w ? ends[f].second : ends[f].first;
+            allowed[i] = 0;
+            for(int j = 0; j < degree; j++) {
+                const int c = start + j;
+                if(c >= windows[i].first && c <= windows[i].second && !isUsed(w, c)
+                    && !isUsed(other, c)) {
+                    allowed[i] |= (uint64_t)1 << j;
+                }
+            }
+        }
+        // every uncolored edge needs its own color of the interval
+        std::fill(matchOf.begin(), matchOf.end(), -1);
+        size_t matched = 0;
+        while(matched < uncolored.size()) {
+            uint64_t visited = 0;
+            if(!augment((int)matched, visited)) {
+                break;
+            }
+            matched++;
+        }
+        if(matched == uncolored.size()) {
+            return false;
+        }
+    }
+
+    if(reason) {
+        // explained by colors at w and at the other ends of its uncolored edges
+        if(global.lowestDepth >= 0) {
+            reason->emplace_back(global.lowestDepth);
+            reason->emplace_back(global.highestDepth);
+        }
+        for(const int f : incident[w]) {
+            if(color[f] != 0) {
+                reason->emplace_back(depthOf[f]);
+                continue;
+            }
+            const int other = ends[f].first == w ? ends[f].second : ends[f].first;
+            for(const int g : incident[other]) {
+                if(color[g] != 0) {
+                    reason->emplace_back(depthOf[g]);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool Search::augment(const int i, uint64_t& visited) {
+    for(uint64_t left = allowed[i] & ~visited; left != 0; left &= left - 1) {
+        const int j = __builtin_ctzll(left);
+        visited |= (uint64_t)1 << j;
+        if(matchOf[j] == -1 || augment(matchOf[j], visited)) {
+            matchOf[j] = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Search::isForbidden(const int e, const int c, std::vector<int>* reason) const {
+    if(nogoodsOf.empty()) {
+        return false;
+    }
+    const auto it = nogoodsOf.find(literalKey(e, c));
+    if(it == nogoodsOf.end()) {
+        return false;
+    }
+    for(const int id : it->second) {
+        bool holds = true;
+        for(const auto& literal : nogoodLiterals[id]) {
+            holds = holds && (literal.first == e || color[literal.first] == literal.second);
+        }
+        if(holds) {
+            if(reason) {
+                for(const auto& literal : nogoodLiterals[id]) {
+                    if(literal.first != e) {
+                        reason->emplace_back(depthOf[literal.first]);
+                    }
+                }
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void Search::orderValues(const int e, std::vector<int>& values) const {
+    std::vector<int> colors;
+    for(const int w : {ends[e].first, ends[e].second}) {
+        for(const int f : incident[w]) {
+            if(color[f] != 0) {
+                colors.emplace_back(color[f]);
+            }
+        }
+    }
+    if(colors.empty()) {
+        colors.emplace_back(span);
+    }
+    auto distance = [&colors](const int c) {
+        int d = INT_MAX;
+        for(const int x : colors) {
+            d = std::min(d, std::abs(c - x));
+        }
+        return d;
+    };
+    std::stable_sort(values.begin(), values.end(), [&distance](const int a, const int b) {
+        return distance(a) < distance(b);
+    });
+}
+
+void Search::assign(const int e, const int c) {
+    Level& level = levels.back();
+    const int depth = (int)levels.size() - 1;
+    level.global = global;
+    color[e] = c;
+    depthOf[e] = depth;
+    if(c < global.lowest) {
+        global.lowest = c;
+        global.lowestDepth = depth;
+    }
+    if(c > global.highest) {
+        global.highest = c;
+        global.highestDepth = depth;
+    }
+    int side = 0;
+    for(const int w : {ends[e].first, ends[e].second}) {
+        level.windows[side++] = std::make_pair(low[w], high[w]);
+        low[w] = std::min(low[w], c);
+        high[w] = std::max(high[w], c);
+        numColored[w]++;
+        usedColors[w * usedWords + c / 64] |= (uint64_t)1 << (c % 64);
+    }
+}
+
+void Search::unassign(Level& level) {
+    const int e = level.edge, c = color[e];
+    int side = 0;
+    for(const int w : {ends[e].first, ends[e].second}) {
+        low[w] = level.windows[side].first;
+        high[w] = level.windows[side].second;
+        side++;
+        numColored[w]--;
+        usedColors[w * usedWords + c / 64] &= ~((uint64_t)1 << (c % 64));
+    }
+    global = level.global;
+    color[e] = 0;
+    depthOf[e] = -1;
+}
+
+bool Search::backjump(std::vector<int> conflict) {
+    std::sort(conflict.begin(), conflict.end());
+    conflict.erase(std::unique(conflict.begin(), conflict.end()), conflict.end());
+    while(!levels.empty()) {
+        const int depth = (int)levels.size() - 1;
+        Level& level = levels.back();
+        unassign(level);
+        if(conflict.empty() || conflict.back() != depth) {
+            levels.pop_back();
+            continue;
+        }
+
+        conflict.pop_back();
+        std::vector<int> merged;
+        std::set_union(level.conflict.begin(), level.conflict.end(), conflict.begin(), conflict.end(),
+            std::back_inserter(merged));
+        level.conflict.swap(merged);
+        if(level.next < level.values.size()) {
+            assign(level.edge, level.values[level.next++]);
+            return true;
+        }
+
+        conflict.swap(level.conflict);
+        levels.pop_back();
+        learn(conflict);
+    }
+    return false;
+}
+
+void Search::learn(const std::vector<int>& conflict) {
+    if(conflict.empty() || conflict.size() > MAX_NOGOOD_SIZE || nogoodLiterals.size() >= MAX_NOGOODS) {
+        return;
+    }
+    const int id = (int)nogoodLiterals.size();
+    nogoodLiterals.emplace_back();
+    for(const int depth : conflict) {
+        const int e = levels[depth].edge;
+        nogoodLiterals.back().emplace_back(e, color[e]);
+        nogoodsOf[literalKey(e, color[e])].emplace_back(id);
+    }
+}
+
+bool Search::limitReached() const {
+    if(limits.maxNodes > 0 && numNodes >= limits.maxNodes) {
+        return true;
+    }
+    if(limits.cancelled && limits.cancelled->load(std::memory_order_relaxed)) {
+        return true;
+    }
+    if(limits.maxSeconds > 0 && numNodes % 256 == 0) {
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() > limits.maxSeconds;
+    }
+    return false;
+}
+
+void Search::moveTo(Graph& outGraph) const {
+    int lowest = INT_MAX;
+    for(const int c : color) {
+        lowest = std::min(lowest, c);
+    }
+    for(size_t e = 0; e < ends.size(); e++) {
+        outGraph.addEdge(Edge(vertexIds[ends[e].first], vertexIds[ends[e].second], color[e] + 1 - lowest));
+    }
+}
+
+}
+
+ExactResult colorExact(Graph& graph, Graph& outGraph, const ExactLimits& limits, SolverStats* stats) {
+    const auto start = std::chrono::steady_clock::now();
+    const int numVertices = graph.numVertices(), numEdges = graph.numEdges();
+    std::vector<Graph> components = graph.splitComponents();
+    graph = emptyGraph();
+
+    ExactResult result = ExactResult::Colored;
+    long long nodes = 0, nogoods = 0;
+    for(size_t i = 0; i < components.size(); i++) {
+        Search search(components[i], limits, start);
+        const ExactResult componentResult = search.run();
+        nodes += search.nodes();
+        nogoods += search.nogoods();
+        if(componentResult == ExactResult::Colored) {
+            search.moveTo(outGraph);
+            continue;
+        }
+        LOG_DEBUG("Component " << i << (componentResult == ExactResult::Infeasible
+            ? " has no interval coloring" : " reached search limit"));
+        components[i].moveAllEdgesToAnotherGraph(graph);
+        if(result != ExactResult::Infeasible) {
+            result = componentResult;
+        }
+    }
+
+    if(stats) {
+        *stats = SolverStats();
+        stats->vertices = numVertices;
+        stats->edges = numEdges;
+        stats->success = result == ExactResult::Colored;
+        stats->backtrackNodes = nodes;
+        stats->nogoodsLearned = nogoods;
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        stats->totalTime = elapsed.count();
+    }
+    return result;
+}
@@ -0,0 +1,72 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include "../include/gcolor.h"
+#include "../include/component_coloring.h"
+#include "../include/graph.h"
+#include "../include/portfolio.h"
+
+ColoringStatus colorEdges(const int* ends, const size_t numEdges, int* colors,
+        const ColoringOptions& options, SolverStats* stats) {
+    if(numEdges > 0 && (!ends || !colors)) {
+        return ColoringStatus::InvalidInput;
+    }
+    // every edge is a row of its own, rows may repeat
+    AdjacencyRows rows;
+    rows.rowIds.reserve(numEdges);
+    rows.rowOffsets.reserve(numEdges + 1);
+    rows.neighbourIds.reserve(numEdges);
+    for(size_t i = 0; i < numEdges; i++) {
+        if(ends[2 * i] == ends[2 * i + 1]) {
+            return ColoringStatus::InvalidInput;
+        }
+        rows.rowIds.emplace_back(ends[2 * i]);
+        rows.neighbourIds.emplace_back(ends[2 * i + 1]);
+        rows.rowOffsets.emplace_back(i + 1);
+    }
+    Graph graph(rows);
+    AdjList a;
+    Graph outGraph(a);
+
+    ColoringStatus status;
+    if(options.exact) {
+        ExactLimits limits = options.exactLimits;
+        limits.cancelled = options.cancelled;
+        const ExactResult result = colorExact(graph, outGraph, limits, stats);
+        status = result == ExactResult::Colored ? ColoringStatus::Colored
+            : result == ExactResult::Infeasible ? ColoringStatus::Infeasible
+            : ColoringStatus::LimitReached;
+    } else if(options.numInstances > 1) {
+        status = colorPortfolio(graph, outGraph, options.numInstances, options.numThreads, stats,
+            options.cancelled) ? ColoringStatus::Colored : ColoringStatus::Failed;
+    } else {
+        SolverConfig config;
+        config.reseed(options.seed);
+        config.cancelled = options.cancelled;
+        status = colorComponents(graph, outGraph, options.numThreads, stats, &config)
+            ? ColoringStatus::Colored : ColoringStatus::Failed;
+    }
+
+    for(size_t i = 0; i < numEdges; i++) {
+        const int v1 = ends[2 * i], v2 = ends[2 * i + 1];
+        colors[i] = outGraph.isEdge(v1, v2) ? outGraph.getEdge(v1, v2).color : 0;
+    }
+    return status;
+}
+
+ColoringResult colorEdges(const std::vector<std::pair<int, int> >& edges,
+        const ColoringOptions& options) {
+    std::vector<int> ends;
+    ends.reserve(2 * edges.size());
+    for(const auto& edge : edges) {
+        ends.emplace_back(edge.first);
+        ends.emplace_back(edge.second);
+    }
+    ColoringResult result;
+    result.colors.assign(edges.size(), 0);
+    result.status = colorEdges(ends.data(), edges.size(), result.colors.data(), options,
+        &result.stats);
+    return result;
+}
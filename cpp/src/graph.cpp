@@ -4,15 +4,19 @@
  */
 
 #include "../include/graph.h"
+#include "../include/graph_loader.h"
+#include "../include/binary_format.h"
+#include "../include/log.h"
+#include "../include/graph_pool.h"
 
 #include <fstream>
-#include <sstream>
 #include <iostream>
 #include <algorithm>
-#include <set>
+#include <array>
+#include <climits>
 #include <deque>
-
-bool verbose = false;
+#include <map>
+#include <stdexcept>
 
 std::ostream& operator<< (std::ostream& os, const Graph& graph) {
     for (auto& kv : graph.getAdj()) {
@@ -33,33 +37,80 @@ Graph::Graph(std::string fileName) {
 }
 
 Graph::Graph(AdjList& a) {
-    adj = a;
+    std::vector<int> rowIds, neighbourIds;
+    std::vector<size_t> rowOffsets{0};
+    for(const auto& kv : a) {
+        rowIds.emplace_back(kv.first);
+        for(const auto& e : kv.second) {
+            neighbourIds.emplace_back(e.v2);
+        }
+        rowOffsets.emplace_back(neighbourIds.size());
+    }
+    core.build(rowIds, rowOffsets, neighbourIds);
+
+    for(const auto& kv : a) {
+        for(const auto& e : kv.second) {
+            if(e.color != 0) {
+                const int id = edgeId(e.v1, e.v2);
+                if(id != -1) {
+                    setEdgeColor(id, e.color);
+                }
+            }
+        }
+    }
+}
+
+Graph::Graph(const AdjacencyRows& rows) {
+    core.build(rows.rowIds, rows.rowOffsets, rows.neighbourIds);
+}
+
+Graph::Graph(const char* data, const size_t size) {
+    if(!load(data, size)) {
+        LOG_ERROR("Invalid binary graph");
+    }
 }
 
 void Graph::deserialize(std::string fileName) {
-    std::ifstream file(fileName);
-    std::string line;
-    while (getline(file, line)) {
-        std::istringstream iss(line);
-        int vertex, neighbour;
+    MappedFile file(fileName);
+    if(!file.isOpen()) {
+        load(nullptr, 0);
+    } else if(!load(file.data(), file.size())) {
+        LOG_ERROR("Invalid binary graph file " << fileName);
+    }
+}
 
-        iss >> vertex;
-        adj[vertex] = std::vector<Edge>();
-        while (iss >> neighbour) {
-            adj[vertex].emplace_back(vertex, neighbour);
+bool Graph::load(const char* data, const size_t size) {
+    adjViewDirty = true;
+    if(data && isBinaryGraph(data, size)) {
+        BinaryGraphView view(data, size);
+        if(!view.isValid()) {
+            return false;
+        }
+        readBinaryGraph(view, core);
+        for(int e = 0; e < (int)view.numEdges(); e++) {
+            if(view.colors()[e] != 0) {
+                setEdgeColor(e, view.colors()[e]);
+            }
         }
+    } else {
+        AdjacencyRows rows;
+        if(data) {
+            parseAdjacencyRows(data, data + size, rows);
+        }
+        core.build(rows.rowIds, rows.rowOffsets, rows.neighbourIds);
     }
+    return true;
 }
 
 void Graph::serialize(std::string fileName) const {
 
-    std::cout << "Saving dotfile graph to " << fileName << ".dot" << std::endl;
+    LOG_INFO("Saving dotfile graph to " << fileName << ".dot");
 
     std::ofstream file(fileName + ".dot");
     if (file) {
         file << "graph {" << std::endl;
 
-        for (auto& kv : adj) {
+        for (auto& kv : getAdj()) {
             for (auto& neighbour : kv.second) {
                 if(neighbour.v1 <= neighbour.v2) {
                     file << "    " << neighbour.v1 << " -- " << neighbour.v2
@@ -71,11 +122,11 @@ void Graph::serialize(std::string fileName) const {
         file << "}" << std::endl;
     }
 
-    std::cout << "Saving raw text graph to " << fileName << ".txt" << std::endl;
+    LOG_INFO("Saving raw text graph to " << fileName << ".txt");
 
     std::ofstream filetxt(fileName + ".txt");
     if(filetxt) {
-        for (auto& kv : adj) {
+        for (auto& kv : getAdj()) {
             filetxt << kv.first << ": ";
             for (auto& edge : kv.second) {
                 filetxt << edge.v2 << "(" << edge.color << "), "; 
@@ -85,138 +136,614 @@ void Graph::serialize(std::string fileName) const {
     }
 }
 
+bool Graph::serializeBinary(std::string fileName) const {
+
+    LOG_INFO("Saving binary graph to " << fileName);
+
+    return writeBinaryGraph(core, fileName);
+}
+
+void Graph::serializeAdjacency(std::string fileName) const {
+
+    LOG_INFO("Saving adjacency list to " << fileName);
+
+    std::ofstream file(fileName);
+    if(file) {
+        for(auto& kv : getAdj()) {
+            file << kv.first;
+            for(auto& edge : kv.second) {
+                file << " " << edge.v2;
+            }
+            file << '\n';
+        }
+    }
+}
+
 const std::map<int, std::vector<Edge>>& Graph::getAdj() const {
-    return adj;
+    if(adjViewDirty) {
+        adjView.clear();
+        for(int v = 0; v < core.vertexCapacity(); v++) {
+            if(!core.isPresent(v)) {
+                continue;
+            }
+            const int id = core.idOf(v);
+            auto& edges = adjView[id];
+            edges.reserve(core.degree(v));
+            for(int i = 0; i < core.degree(v); i++) {
+                edges.emplace_back(id, core.idOf(core.neighbour(v, i)),
+                    core.edge(core.edgeAt(v, i)).color);
+            }
+        }
+        adjViewDirty = false;
+    }
+    return adjView;
+}
+
+bool Graph::isEmpty() const {
+    return core.empty();
 }
 
 void Graph::addEdge(const Edge& e) {
-    adj[e.v1].emplace_back(e.v1, e.v2, e.color);
-    adj[e.v2].emplace_back(e.v2, e.v1, e.color);
+    const int v1 = core.addVertex(e.v1), v2 = core.addVertex(e.v2);
+    if(core.findEdge(v1, v2) != -1) {
+        return;
+    }
+    core.addEdge(v1, v2, e.color);
+    if(e.color != 0) {
+        countColor(v1, e.color, 1, 0);
+        countColor(v2, e.color, 1, 0);
+    }
+    touchPathStart(v1);
+    touchPathStart(v2);
+    adjViewDirty = true;
+    cyclesDirty = true;
 }
 
-std::vector<Edge*> Graph::pathEdges(const std::vector<int>& elem) {
+void Graph::setEdgeColor(const int e, const int color) {
+    Edge& edge = core.edge(e);
+    if(edge.color == color) {
+        return;
+    }
+    if(recordingTrail) {
+        trail.emplace_back(e, edge.color);
+    }
+    const auto& ends = core.endpoints(e);
+    if(edge.color != 0) {
+        countColor(ends.first, edge.color, -1, 0);
+        countColor(ends.second, edge.color, -1, 0);
+    }
+    edge.color = color;
+    if(color != 0) {
+        countColor(ends.first, color, 1, 0);
+        countColor(ends.second, color, 1, 0);
+    }
+    adjViewDirty = true;
+}
 
-    std::vector<Edge*> edges;
-    for(size_t i = 0; i < elem.size()-1; i++) {
-        int currentVertex = elem[i], nextVertex = elem[i+1];
-        for(size_t j = 0; j < adj.at(currentVertex).size(); j++) {
-            if(adj.at(currentVertex)[j].v2 == nextVertex) {
-                edges.emplace_back(&adj.at(currentVertex)[j]);
-                break;
+void Graph::countColor(const int v, const int color, const int edgeDelta, 
+    const int constraintDelta) {
+
+    if((int)summaries.size() <= v) {
+        summaries.resize(core.vertexCapacity());
+    }
+    ColorSummary& summary = summaries[v];
+    touchPathStart(v);
+
+    const int after = colorCounts.add(v, color, 2 * edgeDelta + constraintDelta);
+    const int before = after - 2 * edgeDelta - constraintDelta;
+
+    if(before / 2 < 2 && after / 2 >= 2) {
+        summary.duplicates++;
+    } else if(before / 2 >= 2 && after / 2 < 2) {
+        summary.duplicates--;
+    }
+
+    if(before == 0 && after > 0) {
+        summary.distinct++;
+        if(!summary.stale) {
+            if(summary.lowest == -1 || color < summary.lowest) {
+                summary.lowest = color;
             }
+            if(summary.highest == -1 || color > summary.highest) {
+                summary.highest = color;
+            }
+        }
+    } else if(before > 0 && after == 0) {
+        summary.distinct--;
+        if(summary.distinct == 0) {
+            summary.lowest = summary.highest = -1;
+            summary.stale = false;
+        } else if(color == summary.lowest || color == summary.highest) {
+            // recomputed lazily, on the next query
+            summary.stale = true;
+        }
+    }
+}
+
+void Graph::refreshSummary(const int v) const {
+    ColorSummary& summary = summaries[v];
+    int lowest = -1, highest = -1;
+    const auto consider = [&lowest, &highest](const int c) {
+        if(lowest == -1 || c < lowest) {
+            lowest = c;
+        }
+        if(highest == -1 || c > highest) {
+            highest = c;
+        }
+    };
+    const auto it = constraints.find(core.idOf(v));
+    if(it != constraints.end() && !it->second.empty()) {
+        consider(it->second.lowest());
+        consider(it->second.highest());
+    }
+    for(int i = 0; i < core.degree(v); i++) {
+        const int color = core.edge(core.edgeAt(v, i)).color;
+        if(color != 0) {
+            consider(color);
+        }
+    }
+    summary.lowest = lowest;
+    summary.highest = highest;
+    summary.stale = false;
+}
+
+const ColorSummary& Graph::summaryOf(const int vertexIndex) const {
+    return summaryAt(core.indexOf(vertexIndex));
+}
+
+const ColorSummary& Graph::summaryAt(const int v) const {
+    static const ColorSummary emptySummary;
+    if(v == -1 || v >= (int)summaries.size()) {
+        return emptySummary;
+    }
+    if(summaries[v].stale) {
+        refreshSummary(v);
+    }
+    return summaries[v];
+}
+
+int Graph::edgeId(const int v1, const int v2) const {
+    const int a = core.indexOf(v1), b = core.indexOf(v2);
+    if(a == -1 || b == -1) {
+        return -1;
+    }
+    return core.findEdge(a, b);
+}
+
+std::vector<EdgeHandle> Graph::pathEdges(const std::vector<int>& elem) const {
+
+    std::vector<EdgeHandle> edges;
+    if(elem.empty()) {
+        return edges;
+    }
+    edges.reserve(elem.size()-1);
+    for(size_t i = 0; i < elem.size()-1; i++) {
+        const int currentVertex = elem[i], nextVertex = elem[i+1];
+        const int id = edgeId(currentVertex, nextVertex);
+        if(id == -1) {
+            continue;
         }
+        edges.emplace_back(this, id, core.edge(id).v1 != currentVertex);
     }
     return edges;
 }
 
-bool Graph::colorPath(std::vector<Edge*> edges) {
+bool Graph::colorPath(std::vector<EdgeHandle> edges) {
 
-    std::cout << " === Coloring path" << std::endl;
+    LOG_DEBUG(" === Coloring path");
 
     int startingIndex = 0;
     for(size_t i = 0; i < edges.size(); i++) {
         // find a constrained vertex
-        auto legals = legalColoringsOf(edges[i]->v1);
+        auto legals = legalColoringsOf(edges[i].v1());
         if(!legals.empty()) {
             startingIndex = i;
-            std::cout << "Found a constraint at element " << startingIndex << 
-                        " of path" << std::endl;
+            LOG_DEBUG("Found a constraint at element " << startingIndex << " of path");
             break;
         }
     }
 
     // loop around path so that we start with constrainted vertex
-    std::vector<Edge*> offsetEdges;
+    std::vector<EdgeHandle> offsetEdges;
     const int numEdges = edges.size();
     for(int i = 0; i < numEdges; i++) {
         offsetEdges.emplace_back(edges[(i+startingIndex) % numEdges]);
     }
 
-    if(verbose) {
-        std::cout << "Applied offset: ";
+    if(logEnabled(LogLevel::Trace)) {
+        std::vector<int> offsetVertices;
         for(const auto e : offsetEdges) {
-            std::cout << e->v1 << ", ";
+            offsetVertices.emplace_back(e.v1());
         }
-        std::cout << std::endl;
+        LOG_TRACE("Applied offset: " << logList(offsetVertices));
     }
 
-    return colorPathRecur(offsetEdges.begin(), offsetEdges.end());
+    return backtrackPath(offsetEdges);
 }
 
-bool Graph::colorPathRecur(std::vector<Edge*>::iterator edge, 
-    std::vector<Edge*>::iterator end) {
+bool Graph::backtrackPath(std::vector<EdgeHandle>& edges) {
+    const int numEdges = edges.size();
+    // legal colors of every edge on the stack and index of the next one to try
+    std::vector<std::vector<int> > legals(numEdges);
+    std::vector<size_t> nextColor(numEdges, 0);
 
-    // looped around?
-    if(edge == end) {
-        if(verbose) std::cout << "Backtrack coloring reached end" << std::endl;
+    // vertices whose gaps are checked and number of path edges at each of them
+    std::map<int, int> pathDegree;
+    for(int i = 0; i < numEdges; i++) {
+        pathDegree[edges[i].v1()] = 0;
+    }
+    for(int i = 0; i < numEdges; i++) {
+        for(const int v : {edges[i].v1(), edges[i].v2()}) {
+            auto it = pathDegree.find(v);
+            if(it != pathDegree.end()) {
+                it->second++;
+            }
+        }
+    }
+    // path edges left uncolored at both ends of every edge once it is colored,
+    // a vertex can not miss more colors than that; -1 if ends are not checked
+    std::vector<std::array<int, 2> > edgesLeft(numEdges, std::array<int, 2>{{-1, -1}});
+    for(int i = 0; i < numEdges; i++) {
+        const int ends[2] = {edges[i].v1(), edges[i].v2()};
+        for(int k = 0; k < 2; k++) {
+            auto it = pathDegree.find(ends[k]);
+            if(it != pathDegree.end()) {
+                edgesLeft[i][k] = --it->second;
+            }
+        }
+    }
+    const auto feasible = [&](const int depth) {
+        const int ends[2] = {edges[depth].v1(), edges[depth].v2()};
+        for(int k = 0; k < 2; k++) {
+            if(edgesLeft[depth][k] == -1) {
+                continue;
+            }
+            const ColorSummary& summary = summaryOf(ends[k]);
+            const int missing = summary.empty() ? 0 : summary.highest - summary.lowest + 1 - summary.distinct;
+            if(missing > edgesLeft[depth][k]) {
+                LOG_TRACE("Color gaps found at index " << ends[k]);
+                return false;
+            }
+        }
         return true;
+    };
+
+    // colors set by the search go on the trail, every level undoes its
+    // own changes by popping the trail back to its mark
+    const size_t base = trail.size();
+    recordingTrail = true;
+    std::vector<size_t> marks(numEdges, base);
+
+    int depth = 0;
+    bool entering = true;
+    bool childSucceeded = false;
+    while(depth >= 0) {
+        if(entering) {
+            if(stats) {
+                stats->backtrackNodes++;
+            }
+            if(config && config->isCancelled()) {
+                undoTrail(base);
+                recordingTrail = false;
+                return false;
+            }
+            // looped around?
+            if(depth == numEdges) {
+                LOG_TRACE("Backtrack coloring reached end");
+                childSucceeded = true;
+                entering = false;
+                depth--;
+                continue;
+            }
+            legals[depth] = legalColoringsOfEdge(edges[depth].v1(), edges[depth].v2());
+            if(edgesLeft[depth][1] != -1 && legals[depth].size() > 1) {
+                // least constraining first: fewest colors missing at v2
+                const int v2 = edges[depth].v2();
+                std::vector<std::pair<int, int> > byGaps;
+                for(const int c : legals[depth]) {
+                    byGaps.emplace_back(gapsWith(v2, c), c);
+                }
+                std::stable_sort(byGaps.begin(), byGaps.end(),
+                    [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+                        return a.first < b.first;
+                    });
+                for(size_t i = 0; i < byGaps.size(); i++) {
+                    legals[depth][i] = byGaps[i].second;
+                }
+            }
+            nextColor[depth] = 0;
+            marks[depth] = trail.size();
+        } else if(childSucceeded) {
+            depth--;
+            continue;
+        }
+
+        const EdgeHandle& edge = edges[depth];
+        bool descended = false;
+        while(nextColor[depth] < legals[depth].size()) {
+            const int currentColor = legals[depth][nextColor[depth]++];
+            LOG_TRACE("Trying color: " << currentColor);
+            undoTrail(marks[depth]);
+            setEdgeColor(edge.id(), currentColor);
+            if(feasible(depth)) {
+                depth++;
+                entering = true;
+                descended = true;
+                break;
+            }
+        }
+        if(!descended) {
+            LOG_TRACE("Failed to color vertex " << edge.v1());
+            const size_t undone = undoTrail(marks[depth]);
+            if(stats) {
+                stats->backtrackUndone += undone;
+            }
+            childSucceeded = false;
+            entering = false;
+            depth--;
+        }
+    }
+    trail.resize(base);
+    recordingTrail = false;
+    return childSucceeded;
+}
+
+size_t Graph::undoTrail(const size_t mark) {
+    const bool recording = recordingTrail;
+    recordingTrail = false;
+    const size_t undone = trail.size() - mark;
+    while(trail.size() > mark) {
+        setEdgeColor(trail.back().first, trail.back().second);
+        trail.pop_back();
     }
+    recordingTrail = recording;
+    return undone;
+}
 
-    const int currentVertexIdx = (*edge)->v1, nextVertexIdx = (*edge)->v2;
+int Graph::gapsWith(const int vertexIndex, const int color) const {
+    const ColorSummary& summary = summaryOf(vertexIndex);
+    if(summary.empty()) {
+        return 0;
+    }
+    const int lowest = std::min(summary.lowest, color), highest = std::max(summary.highest, color);
+    const int v = core.indexOf(vertexIndex);
+    const bool isNew = v == -1 || colorCounts.find(v, color) == -1;
+    return highest - lowest + 1 - summary.distinct - (isNew ? 1 : 0);
+}
 
-    const std::vector<int> legalsOfEdge = legalColoringsOfEdge(currentVertexIdx, 
-        nextVertexIdx);
+namespace {
 
-    for(const int currentColor : legalsOfEdge) {
+/**
+ * Colors a vertex of a path already has, see Graph::colorPathDP.
+ */
+struct PathWindow {
+    explicit PathWindow(ColorSet c) : colors(std::move(c)), count(colors.size()) {
+        if(count > 0) {
+            lowest = colors.lowest();
+            highest = colors.highest();
+            if(highest - lowest + 1 - count <= 2) {
+                for(int g = lowest; g < highest; g++) {
+                    if(!colors.contains(g)) {
+                        gaps.emplace_back(g);
+                    }
+                }
+            }
+        }
+    }
 
-        if(verbose) std::cout << "Trying color: " << currentColor << std::endl;
-        colorEdge(currentVertexIdx, nextVertexIdx, currentColor);
-        if(colorPathRecur(++edge, end)) {
-            // see if our colors are fine
-            if(!areGaps(currentVertexIdx)) {
-                return true;
-            } else {
-                if(verbose) std::cout << "Color gaps found at index " << currentVertexIdx << 
-                    " - zeroing path ahead." << std::endl;
-                // zero path ahead of us
-                --edge;
-                zeroPath(++edge, end);
+    /**
+     * Number of colors missing after adding path colors a and b (0 for none),
+     * -1 if some color would be used twice.
+     */
+    int missingWith(const int a, const int b) const {
+        int lo = count > 0 ? lowest : INT_MAX, hi = count > 0 ? highest : INT_MIN, n = count;
+        for(const int c : {a, b}) {
+            if(c == 0) {
+                continue;
+            }
+            if(colors.contains(c)) {
+                return -1;
+            }
+            lo = std::min(lo, c);
+            hi = std::max(hi, c);
+            n++;
+        }
+        if(a != 0 && a == b) {
+            return -1;
+        }
+        return n == 0 ? 0 : hi - lo + 1 - n;
+    }
+
+    ColorSet colors;
+    int count;
+    int lowest = 0, highest = 0;
+    /**
+     * Missing colors, only if there are at most two of them.
+     */
+    std::vector<int> gaps;
+};
+
+}
+
+bool Graph::colorPathDP(const std::vector<EdgeHandle>& edges) {
+    const int numEdges = edges.size();
+    if(numEdges == 0) {
+        return true;
+    }
+    // the search is deterministic, seeded solvers keep their own choices
+    if(config && config->seed != 0) {
+        return colorPath(edges);
+    }
+    std::vector<int> vertices{edges[0].v1()};
+    for(int i = 0; i < numEdges; i++) {
+        if(edges[i].v1() != vertices.back()) {
+            return colorPath(edges);
+        }
+        vertices.emplace_back(edges[i].v2());
+    }
+    const bool isCycle = numEdges > 2 && vertices.back() == vertices.front();
+    std::vector<int> distinct(vertices.begin(), vertices.end() - (isCycle ? 1 : 0));
+    std::sort(distinct.begin(), distinct.end());
+    if(std::adjacent_find(distinct.begin(), distinct.end()) != distinct.end()) {
+        return colorPath(edges);
+    }
+    if(config && config->isCancelled()) {
+        return false;
+    }
+
+    // a cycle starts at a vertex with colors, so that it has few first colors
+    std::vector<EdgeHandle> path(edges);
+    if(isCycle) {
+        int start = 0;
+        while(start < numEdges && summaryOf(vertices[start]).empty()) {
+            start++;
+        }
+        std::rotate(path.begin(), path.begin() + start % numEdges, path.end());
+        vertices.pop_back();
+        std::rotate(vertices.begin(), vertices.begin() + start % numEdges, vertices.end());
+    }
+
+    std::vector<PathWindow> windows;
+    windows.reserve(vertices.size());
+    int maxColor = 0;
+    for(const int v : vertices) {
+        windows.emplace_back(allColorsOf(v));
+        maxColor = std::max(maxColor, windows.back().count > 0 ? windows.back().highest : 0);
+    }
+    // colors above the largest one plus two can be folded onto it plus two and three,
+    // so this range has a coloring if there is any; like colorPath, leave room below 10
+    const int top = std::max(maxColor, 10) + 3;
+    const size_t stride = top + 1;
+
+    std::vector<int> firstColors;
+    const PathWindow& first = windows[0];
+    if(first.count == 0 && isCycle) {
+        // nothing constrains the cycle, any start color does
+        firstColors.emplace_back(10);
+    } else if(first.count == 0) {
+        for(int d = 0; d < top; d++) {
+            const int c = d % 2 == 0 ? 10 + d / 2 : 10 - (d + 1) / 2;
+            if(c >= 1 && c <= top) {
+                firstColors.emplace_back(c);
+            }
+        }
+    } else {
+        std::vector<int> candidates{first.lowest - 2, first.lowest - 1, first.highest + 1, first.highest + 2};
+        candidates.insert(candidates.end(), first.gaps.begin(), first.gaps.end());
+        for(const int c : candidates) {
+            const int missing = first.missingWith(c, 0);
+            if(c >= 1 && c <= top && missing >= 0 && missing <= (isCycle ? 1 : 0)) {
+                firstColors.emplace_back(c);
+            }
+        }
+    }
+
+    // last vertex of a path may be completed by its other edges
+    int freeAtEnd = 0;
+    if(!isCycle) {
+        const int v = core.indexOf(vertices.back());
+        for(int i = 0; v != -1 && i < core.degree(v); i++) {
+            freeAtEnd += core.edge(core.edgeAt(v, i)).color == 0;
+        }
+        freeAtEnd--;
+    }
+
+    // from[i * stride + c]: color of edge i - 1 that edge i colored c follows, -1 if none
+    std::vector<int> from(numEdges * stride);
+    std::vector<int> reached, next, candidates;
+    const size_t attempts = isCycle ? firstColors.size() : 1;
+    for(size_t attempt = 0; attempt < attempts; attempt++) {
+        std::fill(from.begin(), from.end(), -1);
+        reached.clear();
+        if(isCycle) {
+            reached.emplace_back(firstColors[attempt]);
+        } else {
+            reached = firstColors;
+        }
+        for(const int c : reached) {
+            from[c] = 0;
+        }
+        if(stats) {
+            stats->backtrackNodes += reached.size();
+        }
+
+        for(int i = 1; i < numEdges && !reached.empty(); i++) {
+            const PathWindow& window = windows[i];
+            next.clear();
+            for(const int p : reached) {
+                candidates.assign({p - 1, p + 1});
+                if(window.count > 0) {
+                    candidates.insert(candidates.end(), {std::min(p, window.lowest) - 1,
+                        std::max(p, window.highest) + 1, window.lowest - 1, window.highest + 1});
+                    candidates.insert(candidates.end(), window.gaps.begin(), window.gaps.end());
+                }
+                for(const int c : candidates) {
+                    if(c >= 1 && c <= top && from[i * stride + c] == -1 && window.missingWith(p, c) == 0) {
+                        from[i * stride + c] = p;
+                        next.emplace_back(c);
+                    }
+                }
+            }
+            if(stats) {
+                stats->backtrackNodes += next.size();
             }
+            reached.swap(next);
+        }
+
+        int last = -1;
+        for(const int c : reached) {
+            const int missing = isCycle ? windows[0].missingWith(c, firstColors[attempt])
+                : windows.back().missingWith(c, 0);
+            if(missing == 0 || (!isCycle && missing > 0 && missing <= freeAtEnd)) {
+                last = c;
+                break;
+            }
+        }
+        if(last != -1) {
+            for(int i = numEdges - 1; i >= 0; i--) {
+                setEdgeColor(path[i].id(), last);
+                last = from[i * stride + last];
+            }
+            return true;
         }
-        --edge;
     }
-    if(verbose) std::cout << "Failed to color vertex " << currentVertexIdx << std::endl;
-    colorEdge(currentVertexIdx, nextVertexIdx, 0);
+    LOG_TRACE("No coloring of path exists");
     return false;
 }
 
-void Graph::zeroPath(std::vector<Edge*>::iterator edge, std::vector<Edge*>::iterator end) {
-    if(edge == end) {
-        return;
+void Graph::zeroPath(std::vector<EdgeHandle>::iterator edge, 
+    std::vector<EdgeHandle>::iterator end) {
+    for(; edge != end; ++edge) {
+        if(stats && edge->color() != 0) {
+            stats->backtrackUndone++;
+        }
+        setEdgeColor(edge->id(), 0);
     }
-    colorEdge((*edge)->v1, (*edge)->v2, 0);
-    zeroPath(++edge, end);
 }
 
 std::vector<int> Graph::legalColoringsOf(const int vertexIndex) const {
     std::vector<int> possibleColors;
+    const ColorSummary& summary = summaryOf(vertexIndex);
 
-    if(areGaps(vertexIndex)) {
-        // there's a gap: find it and return it
-        std::vector<int> colors = getAllVertexConstraints(vertexIndex);
-        std::sort(colors.begin(), colors.end());
-        for(int i = 0; i < colors.size()-1; i++) {
-            if(colors[i+1] - colors[i] != 1) {
-                possibleColors.emplace_back((colors[i+1] + colors[i]) / 2);
-                break;
-            }
-        }
+    if(summary.hasGaps()) {
+        // there's a gap: return color in the middle of the first one
+        const ColorSet colors = allColorsOf(vertexIndex);
+        const int gap = colors.firstGap();
+        possibleColors.emplace_back((gap - 1 + colors.next(gap)) / 2);
     } else {
-        const int lowestColor = getLowestColor(vertexIndex),
-            highestColor = getHighestColor(vertexIndex);
+        const int lowestColor = summary.lowest, highestColor = summary.highest;
 
         if(lowestColor == -1) {
             return possibleColors; // any color is fine
         }
-        if(lowestColor > 1) {
-            possibleColors.emplace_back(lowestColor-1);
-            if(lowestColor > 2) {
-                possibleColors.emplace_back(lowestColor-2);
-            }
+        const int reach = config ? config->reach : 2;
+        for(int d = 1; d <= reach && lowestColor - d > 0; d++) {
+            possibleColors.emplace_back(lowestColor-d);
         }
         if(highestColor != -1) {
-            possibleColors.emplace_back(highestColor+1);
-            possibleColors.emplace_back(highestColor+2);
+            for(int d = 1; d <= reach; d++) {
+                possibleColors.emplace_back(highestColor+d);
+            }
         }
     }
 
@@ -224,214 +751,260 @@ std::vector<int> Graph::legalColoringsOf(const int vertexIndex) const {
 }
 
 void Graph::colorEdge(const int v1, const int v2, const int color) {
-    if(verbose) std::cout << "Coloring edge " << v1 << ", " << v2 << " with color " << color << std::endl;
-    for(auto& edge : adj.at(v1)) {
-        if((edge.v1 == v1 && edge.v2 == v2) || (edge.v2 == v1 && edge.v1 == v2)) {
-            edge.color = color;
-        }
+    LOG_TRACE("Coloring edge " << v1 << ", " << v2 << " with color " << color);
+    const int id = edgeId(v1, v2);
+    if(id != -1) {
+        setEdgeColor(id, color);
     }
-    for(auto& edge : adj.at(v2)) {
-        if((edge.v1 == v1 && edge.v2 == v2) || (edge.v2 == v1 && edge.v1 == v2)) {
-            edge.color = color;
-        }
+}
+
+const Edge& Graph::getEdge(const int v1, const int v2) {
+    const int id = edgeId(v1, v2);
+    if(id == -1) {
+        throw std::out_of_range("No edge between given vertices");
     }
+    return core.edge(id);
 }
 
-Edge& Graph::getEdge(const int v1, const int v2) {
-    for(auto& edge : adj.at(v1)) {
-        if((edge.v1 == v1 && edge.v2 == v2) || (edge.v2 == v1 && edge.v1 == v2)) {
-            return edge;
-        }
+std::vector<Edge> Graph::edgesOf(const int vertexIndex) const {
+    std::vector<Edge> edges;
+    const int v = core.indexOf(vertexIndex);
+    if(v == -1) {
+        return edges;
+    }
+    edges.reserve(core.degree(v));
+    for(int i = 0; i < core.degree(v); i++) {
+        edges.emplace_back(vertexIndex, core.idOf(core.neighbour(v, i)),
+            core.edge(core.edgeAt(v, i)).color);
     }
+    return edges;
 }
 
 bool Graph::areGaps(const int vertexIndex) const {
-    const int lowestColor = getLowestColor(vertexIndex),
-        highestColor = getHighestColor(vertexIndex);
-    int sum = 0; 
-    for(const int c : getAllVertexConstraints(vertexIndex)) {
-        sum += c;
-    }
-    const int expectedSum = (highestColor * (highestColor + 1) - 
-        lowestColor * (lowestColor + 1) ) / 2;
-    return sum < expectedSum;
+    return summaryOf(vertexIndex).hasGaps();
 }
 
 int Graph::getLowestColor(const int vertexIndex) const {
-    int lowestColor = -1;
-    for(const int c : getAllVertexConstraints(vertexIndex)) {
-        if(lowestColor == -1) {
-            // first non-zero colour found
-            lowestColor = c;
-        }
-        if(c < lowestColor) {
-            lowestColor = c;
-        }
-    }
-    return lowestColor;
+    return summaryOf(vertexIndex).lowest;
 }
 
 int Graph::getHighestColor(const int vertexIndex) const {
-    int highestColor = -1;
-    for(const int c : getAllVertexConstraints(vertexIndex)) {
-        if(highestColor == -1) {
-            // first non-zero colour found
-            highestColor = c;
-        }
-        if(c > highestColor) {
-            highestColor = c;
-        }
-    }
-    return highestColor;
+    return summaryOf(vertexIndex).highest;
 }
 
 std::vector<int> Graph::findCycle() {
-    // cleanup labels
-    labels.clear();
-    for(auto& keyval : adj) {
-        labels[keyval.first] = false;
+    int start = -1;
+    for(int v = 0; v < core.vertexCapacity(); v++) {
+        if(core.isPresent(v) && (start == -1 || core.idOf(v) < core.idOf(start))) {
+            start = v;
+        }
+    }
+    if(start == -1) {
+        LOG_DEBUG("No cycle found");
+        return {};
     }
 
-    const int startingVertexIdx = labels.begin()->first;
-
-    auto result = findCycleRecur(startingVertexIdx, startingVertexIdx, startingVertexIdx);
+    auto result = findCycleFrom(start);
 
     if(result.size()) {
-        std::reverse(result.begin(), result.end());
-        result.emplace_back(startingVertexIdx);
-
-        std::cout << "Cycle found: ";
-        for(const auto& el : result) {
-            std::cout << el << ", ";
-        }
-        std::cout << std::endl;
+        LOG_DEBUG("Cycle found: " << logList(result));
     } else {
-        std::cout << "No cycle found" << std::endl;
-    }
-
-    // cleanup labels
-    for(auto& keyval : labels) {
-        keyval.second = false;
+        LOG_DEBUG("No cycle found");
     }
-
     return result;
 }
 
-std::vector<int> Graph::findCycleRecur(const int startingVertexIdx, 
-    const int currentVertexIdx, const int prevIdx) {
-    labels[currentVertexIdx] = true;
+std::vector<int> Graph::nextCycle() {
+    std::vector<int> cycle;
+    const auto score = [this](const int v) { return tightnessAt(v); };
+    bool found = false;
+    if(!cyclesDirty) {
+        cycles.reprioritize(retouched, score);
+        retouched.clear();
+        found = cycles.next(core, cycle);
+    }
+    if(!found && (cyclesDirty || !core.empty())) {
+        int start = -1;
+        if(config && config->seed != 0 && !core.empty()) {
+            // first present vertex from a random position
+            const int n = core.vertexCapacity();
+            const int offset = (int)(config->rng() % n);
+            for(int i = 0; i < n && start == -1; i++) {
+                if(core.isPresent((offset + i) % n)) {
+                    start = (offset + i) % n;
+                }
+            }
+        } else {
+            for(int v = 0; v < core.vertexCapacity(); v++) {
+                if(core.isPresent(v) && (start == -1 || core.idOf(v) < core.idOf(start))) {
+                    start = v;
+                }
+            }
+        }
+        cycles.build(core, start);
+        cycles.prioritize(score, config && config->seed != 0 ? &config->rng : nullptr);
+        retouched.clear();
+        cyclesDirty = false;
+        found = cycles.next(core, cycle);
+    }
+    if(!found) {
+        LOG_DEBUG("No cycle found");
+        return {};
+    }
+    for(int& v : cycle) {
+        v = core.idOf(v);
+    }
+    LOG_DEBUG("Cycle found: " << logList(cycle));
+    return cycle;
+}
 
-    for(auto& edge : adj.at(currentVertexIdx)) {
-        const int neighbourIdx = edge.v2;
-        if(neighbourIdx == prevIdx) {
+std::vector<int> Graph::findCycleFrom(const int start) {
+    struct Frame {
+        int v;
+        int prev;
+        int next;
+    };
+    startVisit();
+    visit(start);
+    std::vector<Frame> stack{Frame{start, start, 0}};
+    while(!stack.empty()) {
+        Frame& frame = stack.back();
+        if(frame.next == core.degree(frame.v)) {
+            stack.pop_back();
+            continue;
+        }
+        const int v = frame.v;
+        const int neighbour = core.neighbour(v, frame.next++);
+        if(neighbour == frame.prev) {
             continue;
         }
 
         // loop found right now?
-        if(neighbourIdx == startingVertexIdx) {
-            return std::vector<int>{currentVertexIdx};
+        if(neighbour == start) {
+            std::vector<int> result;
+            result.reserve(stack.size() + 1);
+            for(const Frame& f : stack) {
+                result.emplace_back(core.idOf(f.v));
+            }
+            result.emplace_back(core.idOf(start));
+            return result;
         }
-        
-        if(labels.at(neighbourIdx) == false) {
-
-            auto result = findCycleRecur(startingVertexIdx, edge.v2, currentVertexIdx);
 
-            // loop found by someone we called?
-            if(!result.empty()) {
-                result.emplace_back(currentVertexIdx);
-                return result;
-            }
+        if(!isVisited(neighbour)) {
+            visit(neighbour);
+            stack.push_back(Frame{neighbour, v, 0});
         }
     }
 
     return std::vector<int>{}; // return empty
 }
 
+void Graph::startVisit() {
+    if((int)visitMarks.size() < core.vertexCapacity()) {
+        visitMarks.resize(core.vertexCapacity(), 0);
+    }
+    if(++visitEpoch == 0) {
+        // epoch wrapped around, old marks could look current
+        std::fill(visitMarks.begin(), visitMarks.end(), 0);
+        visitEpoch = 1;
+    }
+}
+
 bool Graph::colorAsForest() {
-    int numUncolored = numEdges();
-    std::cout << " === Coloring forest with " << numUncolored << " edges" << std::endl;
+    GraphPool pool;
+    return colorAsForest(pool);
+}
 
-    AdjList a;
-    auto tempGraph = Graph(a);
-    auto outGraph = Graph(a);
+bool Graph::colorAsForest(GraphPool& pool) {
+    int numUncolored = numEdges();
+    LOG_DEBUG(" === Coloring forest with " << numUncolored << " edges");
+
+    Graph& tempGraph = pool.acquire(stats, config);
+    Graph& outGraph = pool.acquire(stats, config);
+    // edges peeled last are closest to the cycles the forest hung from, move them
+    // first so that searches in tempGraph grow from there towards the leaves
+    for(auto it = peelOrder.rbegin(); it != peelOrder.rend(); ++it) {
+        moveEdgeToAnotherGraph(tempGraph, it->second, it->first);
+    }
     moveAllEdgesToAnotherGraph(tempGraph);
 
-    std::deque<Graph*> graphQueue;
+    // paths that failed to color, parked in tempGraph
+    std::deque<std::vector<int> > graphQueue;
 
     bool justAddedToQueue = false;
     int numTries = 0;
     const int maxNumTries = 10;
     while(numUncolored != 0) {
-        std::cout << " = Next iteration of forest coloring" << std::endl;
-        if(verbose) {
-            std::cout << "Working forest graph: " << std::endl;
-            tempGraph.print();
-        }
+        LOG_DEBUG(" = Next iteration of forest coloring");
+        LOG_TRACE("Working forest graph: ");
+        tempGraph.print();
 
         if(numTries > maxNumTries) {
-            std::cout << "Tried to color the forest " << numTries << " times, failed. Bailing out."
-                      << std::endl;
+            LOG_DEBUG("Tried to color the forest " << numTries << " times, failed. Bailing out.");
+            break;
+        }
+        if(config && config->isCancelled()) {
+            LOG_DEBUG("Forest coloring cancelled");
             break;
         }
         numTries++; 
-        std::cout << "Finding a path in forest" << std::endl;
+        if(stats) {
+            stats->forestIterations++;
+        }
+        LOG_DEBUG("Finding a path in forest");
 
         const std::vector<int> verticesInPath = tempGraph.findPath();
         if(verticesInPath.empty()) {
-            std::cout << "Tree appears to be empty" << std::endl;
+            LOG_DEBUG("Tree appears to be empty");
             if(graphQueue.empty()) {
-                std::cout << "Queue is also empty, done" << std::endl;
+                LOG_DEBUG("Queue is also empty, done");
                 break;
             } else {
-                std::cout << "Moving edges from queue" << std::endl;
-                graphQueue.front()->moveAllEdgesToAnotherGraph(tempGraph);
+                LOG_DEBUG("Moving edges from queue");
+                tempGraph.restoreEdges(graphQueue.front());
                 graphQueue.pop_front();
+                if(stats) {
+                    stats->queuePops++;
+                }
                 continue;
             }
         }
 
         auto edges = tempGraph.pathEdges(verticesInPath);
-        const bool success = tempGraph.colorPath(edges);
+        const bool success = tempGraph.colorPathDP(edges);
 
         if(success) {
-            std::cout << "Coloring was successful" << std::endl;
+            LOG_DEBUG("Coloring was successful");
             
-            for(size_t i = 0; i < verticesInPath.size()-1; i++) {
-                const int v1 = verticesInPath[i], v2 = verticesInPath[i+1];
-                const int color = tempGraph.getEdge(v1, v2).color;
+            for(const auto& edge : edges) {
+                const int v1 = edge.v1(), v2 = edge.v2();
+                const int color = edge.color();
                 
-                for(auto& g : graphQueue) {
-                    g->addVertexConstraint(v1, color);
-                    g->addVertexConstraint(v2, color);
-                }
                 tempGraph.addVertexConstraint(v1, color);
                 tempGraph.addVertexConstraint(v2, color);
-                tempGraph.moveEdgeToAnotherGraph(outGraph, v1, v2);
+                tempGraph.moveEdgeToAnotherGraph(outGraph, edge);
             }
         } else {
-            std::cout << "Failed to color, moving to queue" << std::endl;
-            AdjList aa;
-            Graph* newGraph = new Graph(aa);
-            for(size_t i = 0; i < verticesInPath.size()-1; i++) {
-                const int v1 = verticesInPath[i], v2 = verticesInPath[i+1];
-                tempGraph.moveEdgeToAnotherGraph(*newGraph, v1, v2);
+            LOG_DEBUG("Failed to color, moving to queue");
+            graphQueue.push_back(tempGraph.parkEdges(edges));
+            if(stats) {
+                stats->queuePushes++;
             }
-            graphQueue.push_back(newGraph);
-            justAddedToQueue = true;
         }
     }
 
-    for(auto& g : graphQueue) {
-        g->moveAllEdgesToAnotherGraph(*this);
+    // colored only if no path is left, neither in tempGraph nor parked
+    const bool colored = tempGraph.isEmpty() && graphQueue.empty();
+    for(const auto& fragment : graphQueue) {
+        tempGraph.restoreEdges(fragment);
     }
     graphQueue.clear();
 
     tempGraph.moveAllEdgesToAnotherGraph(*this);
     outGraph.moveAllEdgesToAnotherGraph(*this);
-    if(tempGraph.getAdj().empty() && graphQueue.empty()) {
-        return true;
-    }
-    return false;
+    pool.release(tempGraph);
+    pool.release(outGraph);
+    return colored;
 }
 
 std::vector<int> Graph::legalColoringsOfEdge(const int v1, const int v2) const {
@@ -455,95 +1028,289 @@ std::vector<int> Graph::legalColoringsOfEdge(const int v1, const int v2) const {
             }
         }
     }
+    if(config && config->seed != 0) {
+        std::shuffle(legalsOfEdge.begin(), legalsOfEdge.end(), config->rng);
+    }
     return legalsOfEdge;
 }
 
 void Graph::moveEdgeToAnotherGraph(Graph& other, const int v1, const int v2) {
-    int i = 0, color;
-    for(auto edge : adj.at(v1)) {
-        if((edge.v1 == v1 && edge.v2 == v2) || (edge.v2 == v1 && edge.v1 == v2)) {
-            color = edge.color;
-            adj.at(v1).erase(adj.at(v1).begin() + i);
-            if(adj.at(v1).size() == 0) {
-                adj.erase(v1);
+    const int id = edgeId(v1, v2);
+    if(id == -1) {
+        return;
+    }
+    moveEdgeToAnotherGraph(other, EdgeHandle(this, id, core.edge(id).v1 != v1));
+}
+
+void Graph::moveEdgeToAnotherGraph(Graph& other, const EdgeHandle& edge) {
+    const int id = edge.id();
+    const int v1 = edge.v1(), v2 = edge.v2();
+    const int color = core.edge(id).color;
+    if(color != 0) {
+        countColor(core.endpoints(id).first, color, -1, 0);
+        countColor(core.endpoints(id).second, color, -1, 0);
+    }
+    touchPathStart(core.endpoints(id).first);
+    touchPathStart(core.endpoints(id).second);
+    core.removeEdge(id);
+    adjViewDirty = true;
+
+    if(!other.isEdge(v1, v2)) {
+        other.addEdge(Edge(v1, v2, color));
+        copyConstraintsTo(other, v1);
+        copyConstraintsTo(other, v2);
+    }
+}
+
+void Graph::moveAllEdgesToAnotherGraph(Graph& other) {
+    for(int v = 0; v < core.vertexCapacity(); v++) {
+        if(!core.isPresent(v)) {
+            continue;
+        }
+        const int id = core.idOf(v);
+        for(int i = 0; i < core.degree(v); i++) {
+            const int neighbourId = core.idOf(core.neighbour(v, i));
+            if(!other.isEdge(id, neighbourId)) {
+                other.addEdge(Edge(id, neighbourId, core.edge(core.edgeAt(v, i)).color));
             }
-            break;
         }
-        i++;
+        copyConstraintsTo(other, id);
+    }
+    clear();
+}
+
+void Graph::clear() {
+    core.clear();
+    adjView.clear();
+    adjViewDirty = true;
+    cyclesDirty = true;
+    constraints.clear();
+    peelOrder.clear();
+    summaries.clear();
+    colorCounts.clear();
+    trail.clear();
+    recordingTrail = false;
+    retouched.clear();
+    pathsDirty = true;
+    pathStarts = std::priority_queue<PathStart>();
+    pathTouched.clear();
+    pathTouchedMark.clear();
+}
+
+std::vector<int> Graph::parkEdges(const std::vector<EdgeHandle>& edges) {
+    std::vector<int> fragment;
+    fragment.reserve(edges.size());
+    for(const auto& edge : edges) {
+        const int id = edge.id();
+        const int color = core.edge(id).color;
+        if(color != 0) {
+            countColor(core.endpoints(id).first, color, -1, 0);
+            countColor(core.endpoints(id).second, color, -1, 0);
+        }
+        touchPathStart(core.endpoints(id).first);
+        touchPathStart(core.endpoints(id).second);
+        core.parkEdge(id);
+        fragment.emplace_back(id);
+    }
+    adjViewDirty = true;
+    return fragment;
+}
+
+void Graph::restoreEdges(const std::vector<int>& fragment) {
+    for(const int id : fragment) {
+        core.restoreEdge(id);
+        touchPathStart(core.endpoints(id).first);
+        touchPathStart(core.endpoints(id).second);
+        const int color = core.edge(id).color;
+        if(color != 0) {
+            countColor(core.endpoints(id).first, color, 1, 0);
+            countColor(core.endpoints(id).second, color, 1, 0);
+        }
     }
-    i = 0;
-    for(auto edge : adj.at(v2)) {
-        if((edge.v1 == v1 && edge.v2 == v2) || (edge.v2 == v1 && edge.v1 == v2)) {
-            adj.at(v2).erase(adj.at(v2).begin() + i);
-            if(adj.at(v2).size() == 0) {
-                adj.erase(v2);
+    adjViewDirty = true;
+    cyclesDirty = true;
+}
+
+std::vector<Graph> Graph::splitComponents() const {
+    std::vector<int> component(core.vertexCapacity(), -1);
+    std::vector<std::vector<int> > members;
+    for(int v = 0; v < core.vertexCapacity(); v++) {
+        if(!core.isPresent(v) || core.degree(v) == 0 || component[v] != -1) {
+            continue;
+        }
+        // breadth-first search, members double as the queue
+        const int c = (int)members.size();
+        members.emplace_back(1, v);
+        component[v] = c;
+        auto& queue = members.back();
+        for(size_t next = 0; next < queue.size(); next++) {
+            const int u = queue[next];
+            for(int i = 0; i < core.degree(u); i++) {
+                const int w = core.neighbour(u, i);
+                if(component[w] == -1) {
+                    component[w] = c;
+                    queue.emplace_back(w);
+                }
             }
-            break;
         }
-        i++;
     }
-    if(!other.isEdge(v1, v2)) {
-        other.addEdge(Edge(v1, v2, color));
-        if(constraints.find(v1) != constraints.end()) {
-            for(const int c : constraints.at(v1)) {
-                other.addVertexConstraint(v1, c);
+
+    std::vector<Graph> result;
+    result.reserve(members.size());
+    for(auto& vertices : members) {
+        std::sort(vertices.begin(), vertices.end());
+        std::vector<int> rowIds, neighbourIds;
+        std::vector<size_t> rowOffsets{0};
+        for(const int v : vertices) {
+            rowIds.emplace_back(core.idOf(v));
+            for(int i = 0; i < core.degree(v); i++) {
+                neighbourIds.emplace_back(core.idOf(core.neighbour(v, i)));
             }
+            rowOffsets.emplace_back(neighbourIds.size());
         }
-        if(constraints.find(v2) != constraints.end()) {
-            for(const int c : constraints.at(v2)) {
-                other.addVertexConstraint(v2, c);
+        AdjList a;
+        result.emplace_back(a);
+        Graph& g = result.back();
+        g.core.build(rowIds, rowOffsets, neighbourIds);
+        for(const int v : vertices) {
+            for(int i = 0; i < core.degree(v); i++) {
+                const Edge& e = core.edge(core.edgeAt(v, i));
+                if(e.color != 0 && e.v1 == core.idOf(v)) {
+                    g.setEdgeColor(g.edgeId(e.v1, e.v2), e.color);
+                }
             }
+            copyConstraintsTo(g, core.idOf(v));
         }
     }
+    return result;
 }
 
-void Graph::moveAllEdgesToAnotherGraph(Graph& other) {
-    for(auto& v : adj) {
-        for(auto& e : v.second) {
-            if(!other.isEdge(e.v1, e.v2)) {
-                other.addEdge(Edge(e.v1, e.v2, e.color));
+std::vector<Graph> Graph::splitBlocks() const {
+    BlockDecomposition blocks;
+    blocks.build(core);
+
+    // local index of every dense vertex in the block being built
+    std::vector<int> local(core.vertexCapacity(), -1);
+    std::vector<Graph> result;
+    result.reserve(blocks.numBlocks());
+    for(int b = 0; b < blocks.numBlocks(); b++) {
+        std::vector<int> vertices;
+        for(const int* e = blocks.blockBegin(b); e != blocks.blockEnd(b); e++) {
+            for(const int v : {core.endpoints(*e).first, core.endpoints(*e).second}) {
+                if(local[v] == -1) {
+                    local[v] = (int)vertices.size();
+                    vertices.emplace_back(v);
+                }
             }
         }
-        if(constraints.find(v.first) != constraints.end()) {
-            for(const int c : constraints.at(v.first)) {
-                other.addVertexConstraint(v.first, c);
+        // rows grouped by vertex in order of first appearance
+        std::vector<size_t> rowOffsets(vertices.size() + 1, 0);
+        for(const int* e = blocks.blockBegin(b); e != blocks.blockEnd(b); e++) {
+            rowOffsets[local[core.endpoints(*e).first] + 1]++;
+            rowOffsets[local[core.endpoints(*e).second] + 1]++;
+        }
+        for(size_t i = 1; i < rowOffsets.size(); i++) {
+            rowOffsets[i] += rowOffsets[i-1];
+        }
+        std::vector<size_t> fill(rowOffsets.begin(), rowOffsets.end() - 1);
+        std::vector<int> rowIds, neighbourIds(rowOffsets.back());
+        for(const int v : vertices) {
+            rowIds.emplace_back(core.idOf(v));
+        }
+        for(const int* e = blocks.blockBegin(b); e != blocks.blockEnd(b); e++) {
+            const int v1 = core.endpoints(*e).first, v2 = core.endpoints(*e).second;
+            neighbourIds[fill[local[v1]]++] = core.idOf(v2);
+            neighbourIds[fill[local[v2]]++] = core.idOf(v1);
+        }
+
+        AdjList a;
+        result.emplace_back(a);
+        Graph& g = result.back();
+        g.core.build(rowIds, rowOffsets, neighbourIds);
+        for(const int* e = blocks.blockBegin(b); e != blocks.blockEnd(b); e++) {
+            const Edge& edge = core.edge(*e);
+            if(edge.color != 0) {
+                g.setEdgeColor(g.edgeId(edge.v1, edge.v2), edge.color);
             }
         }
+        for(const int v : vertices) {
+            local[v] = -1;
+            copyConstraintsTo(g, core.idOf(v));
+        }
     }
-    adj.clear();
-    constraints.clear();
+    return result;
+}
+
+bool Graph::isUncolored() const {
+    if(!constraints.empty()) {
+        return false;
+    }
+    for(int e = 0; e < core.edgeCapacity(); e++) {
+        if(core.isEdge(e) && core.edge(e).color != 0) {
+            return false;
+        }
+    }
+    return true;
 }
 
 bool Graph::moveHangingEdgesTo(Graph& outGraph) {
+    // worklist of vertices with a single edge; removing that edge may
+    // leave the neighbour with a single edge as well
+    std::vector<int> hanging;
+    for(int v = 0; v < core.vertexCapacity(); v++) {
+        if(core.isPresent(v) && core.degree(v) == 1) {
+            hanging.emplace_back(v);
+        }
+    }
     bool movedSomething = false;
-    while(true) {
-        Edge* e = findHangingEdge();
-        if(!e) {
-            break;
+    for(size_t next = 0; next < hanging.size(); next++) {
+        const int v = hanging[next];
+        if(!core.isPresent(v) || core.degree(v) != 1) {
+            continue;
+        }
+        const int id = core.edgeAt(v, 0);
+        const int neighbour = core.other(id, v);
+        const EdgeHandle e(this, id, core.endpoints(id).first != v);
+        LOG_DEBUG("Moving hanging edge " << e.v1() << ", " << e.v2());
+        outGraph.peelOrder.emplace_back(e.v1(), e.v2());
+        moveEdgeToAnotherGraph(outGraph, e);
+        if(stats) {
+            stats->hangingEdgesPeeled++;
         }
-        std::cout << "Moving hanging edge " << e->v1 << ", " << e->v2 << std::endl;
-        moveEdgeToAnotherGraph(outGraph, e->v1, e->v2);
         movedSomething = true;
+        if(core.isPresent(neighbour) && core.degree(neighbour) == 1) {
+            hanging.emplace_back(neighbour);
+        }
     }
     return movedSomething;
 }
 
-Edge* Graph::findHangingEdge() {
-    for(const auto& v : adj) {
-        if(v.second.size() == 1) {
-            return &getEdge(v.second[0].v1, v.second[0].v2);
-        }
+bool Graph::color(Graph& outGraph) {
+    PhaseTimer totalTimer(stats, &SolverStats::totalTime);
+    if(stats) {
+        stats->vertices = core.numVertices();
+        stats->edges = core.numEdges();
     }
-    return nullptr;
-}
 
-bool Graph::color(Graph& outGraph) {
-    AdjList a;
-    auto tempGraph = Graph(a);
+    // owns temporary graphs of this call and frees them when it returns
+    GraphPool pool;
+    Graph& tempGraph = pool.acquire(stats, config);
 
-    std::deque<Graph*> graphQueue;
+    // fragments that failed to color, parked in this graph
+    std::deque<std::vector<int> > graphQueue;
 
     bool justAddedToQueue = true;
+    // a failure counts as doing something only until every queued fragment
+    // failed again with nothing colored in between, then retries change nothing
+    int coloredAtLastFailure = -1;
+    size_t failuresWithoutProgress = 0;
+    const auto failedAgain = [&]() {
+        if(outGraph.numEdges() != coloredAtLastFailure) {
+            coloredAtLastFailure = outGraph.numEdges();
+            failuresWithoutProgress = 0;
+        }
+        return ++failuresWithoutProgress > graphQueue.size();
+    };
 
     bool didSomething = true;
     const int triesThreshold = 3;
@@ -555,21 +1322,27 @@ bool Graph::color(Graph& outGraph) {
             triesDidNothing = 0;
         }
         if(triesDidNothing >= triesThreshold) {
-            std::cout << "Tried " << triesDidNothing << " times but did nothing" << std::endl;
+            LOG_DEBUG("Tried " << triesDidNothing << " times but did nothing");
+            break;
+        }
+        if(config && config->isCancelled()) {
+            LOG_DEBUG("Coloring cancelled");
             break;
         }
 
-        std::cout << " ============= Next iteration" << std::endl;
+        LOG_DEBUG(" ============= Next iteration");
 
         if(!graphQueue.empty()) {
             if(justAddedToQueue) {
-                std::cout << "Wanted to add from queue, but something was just added to it. "
-                             "Skipping." << std::endl;
+                LOG_DEBUG("Wanted to add from queue, but something was just added to it. "
+                    "Skipping.");
             } else {
-                std::cout << "Adding from queue" << std::endl;
-                Graph* popped = graphQueue.front();
-                popped->moveAllEdgesToAnotherGraph(*this);
+                LOG_DEBUG("Adding from queue");
+                restoreEdges(graphQueue.front());
                 graphQueue.pop_front();
+                if(stats) {
+                    stats->queuePops++;
+                }
            }
         }
         justAddedToQueue = false;
@@ -577,36 +1350,43 @@ bool Graph::color(Graph& outGraph) {
         printGraphs(tempGraph, outGraph);
 
         didSomething = false;
-        const bool moved = moveHangingEdgesTo(tempGraph);
+        const bool moved = timePhase(stats, &SolverStats::peelingTime, [&] {
+            return moveHangingEdgesTo(tempGraph);
+        });
         if(moved) {
-            std::cout << "Some edges were moved to temporary graph" << std::endl;
+            LOG_DEBUG("Some edges were moved to temporary graph");
             printGraphs(tempGraph, outGraph);
         }
-        if(adj.empty()) {
+        if(core.empty()) {
             // there are no cycles and tempGraph contains a forest.
-            std::cout << "No cycles found" << std::endl;
+            LOG_DEBUG("No cycles found");
 
 
-            if(!tempGraph.getAdj().empty()) {
-                std::cout << "Coloring forest in tempgraph" << std::endl;
+            if(!tempGraph.isEmpty()) {
+                LOG_DEBUG("Coloring forest in tempgraph");
 
-                const bool success = tempGraph.colorAsForest();
+                const bool success = timePhase(stats, &SolverStats::forestColoringTime, [&] {
+                    return tempGraph.colorAsForest(pool);
+                });
                 if(!success) {
-                    std::cout << "Failed to color tempgraph as forest" << std::endl;
+                    LOG_DEBUG("Failed to color tempgraph as forest");
                     didSomething = false;
                 } else {
-                    std::cout << "Colored tempgraph as forest" << std::endl;
+                    LOG_DEBUG("Colored tempgraph as forest");
                     printGraphs(tempGraph, outGraph);
                     didSomething = true;
                 }
 
                 // move all new constraints to graph and everything in the queue
-                for(const auto& v : tempGraph.getAdj()) {
-                    for(const auto& e : v.second) {
-                        addVertexConstraint(v.first, e.color);
-                        for(auto& g : graphQueue) {
-                            g->addVertexConstraint(v.first, e.color);
-                        }
+                const CsrGraph& tempCore = tempGraph.core;
+                for(int v = 0; v < tempCore.vertexCapacity(); v++) {
+                    if(!tempCore.isPresent(v)) {
+                        continue;
+                    }
+                    const int id = tempCore.idOf(v);
+                    for(int i = 0; i < tempCore.degree(v); i++) {
+                        const int color = tempCore.edge(tempCore.edgeAt(v, i)).color;
+                        addVertexConstraint(id, color);
                     }
                 }
 
@@ -614,236 +1394,236 @@ bool Graph::color(Graph& outGraph) {
             }
         } else {
             // there are cycles, find one
-            std::cout << "Finding cycle" << std::endl;
-            const std::vector<int> verticesInCycle = findCycle();
+            LOG_DEBUG("Finding cycle");
+            const std::vector<int> verticesInCycle = timePhase(stats,
+                &SolverStats::cycleSearchTime, [&] { return nextCycle(); });
+            if(stats && !verticesInCycle.empty()) {
+                stats->cyclesFound++;
+            }
 
             const std::vector<int> constraintsInCycle = 
                 findConstrainedVerticesInCycle(verticesInCycle);
 
-            if(verbose) {
-                std::cout << "Found a cycle with " << constraintsInCycle.size()
-                            << " constraints: ";
-                for(const auto c : constraintsInCycle) {
-                    std::cout << c << ", ";
-                }
-                std::cout << std::endl;
-            }
+            LOG_TRACE("Found a cycle with " << constraintsInCycle.size()
+                << " constraints: " << logList(constraintsInCycle));
 
             if(constraintsInCycle.size() <= 1) {
                 // there's at most one constraint in the cycle
 
                 auto edgesInCycle = pathEdges(verticesInCycle);
                 // color it
-                const bool success = colorPath(edgesInCycle);
+                const bool success = timePhase(stats, &SolverStats::pathColoringTime, [&] {
+                    return colorPathDP(edgesInCycle);
+                });
                 if(success) {
-                    std::cout << "Coloring path successful" << std::endl;
+                    LOG_DEBUG("Coloring path successful");
 
-                    for(size_t i = 0; i < verticesInCycle.size()-1; i++) {
-                        const int v1 = verticesInCycle[i], v2 = verticesInCycle[i+1];
-                        const int color = getEdge(v1, v2).color;
+                    for(const auto& edge : edgesInCycle) {
+                        const int v1 = edge.v1(), v2 = edge.v2();
+                        const int color = edge.color();
 
-                        // export new constraints to temp graph, original graph and
-                        // all graphs in queue
+                        // export new constraints to temp graph and original graph,
+                        // parked fragments share constraints of the original graph
                         tempGraph.addVertexConstraint(v1, color);
                         tempGraph.addVertexConstraint(v2, color);
                         addVertexConstraint(v1, color);
                         addVertexConstraint(v2, color);
-                        for(auto& g : graphQueue) {
-                            g->addVertexConstraint(v1, color);
-                        }
 
                         // delete this cycle from graph
-                        moveEdgeToAnotherGraph(outGraph, v1, v2);
+                        moveEdgeToAnotherGraph(outGraph, edge);
                     }
                     printGraphs(tempGraph, outGraph);
                     didSomething = true;
                 } else {
                     // failed to color it, move it to queue
-                    std::cout << "Failed to color, moving to queue" << std::endl;
-                    AdjList a;
-                    auto* newGraph = new Graph(a);
-                    for(size_t i = 0; i < verticesInCycle.size()-1; i++) {
-                        const int v1 = verticesInCycle[i], v2 = verticesInCycle[i+1];
-                        moveEdgeToAnotherGraph(*newGraph, v1, v2);
+                    LOG_DEBUG("Failed to color, moving to queue");
+                    graphQueue.push_back(parkEdges(edgesInCycle));
+                    if(stats) {
+                        stats->queuePushes++;
                     }
-                    graphQueue.push_back(newGraph);
                     justAddedToQueue = true;
-                    didSomething = true;
+                    didSomething = !failedAgain();
                 }
             } else {
                 // there are two or more constraints in the cycle
 
                 const auto paths = splitCycle(verticesInCycle, constraintsInCycle);
-            
-                std::cout << "Split cycle into " << paths.size() << " paths" << std::endl;
-
-                AdjList a;
-                std::vector<Graph> pathGraphs(paths.size(), Graph(a));
-
-                // move each path to a own graph
-                for(size_t i = 0; i < paths.size(); i++) {
-                    const auto currentPath = paths[i];
-
-                    for(size_t j = 0; j < currentPath.size()-1; j++) {
-                        const int v1 = currentPath[j], v2 = currentPath[j+1];
-                        // /const int color = getEdge(v1, v2).color;
-                        moveEdgeToAnotherGraph(pathGraphs[i], v1, v2);
-                    }
+                if(stats) {
+                    stats->pathsSplit += paths.size();
                 }
+            
+                LOG_DEBUG("Split cycle into " << paths.size() << " paths");
 
-                // color each path alone
+                // color each path alone, in place: edges of other paths are
+                // still uncolored, so only constraints and colored edges count
                 for(size_t i = 0; i < paths.size(); i++) {
-                    pathGraphs[i].print();
-
                     const auto currentPath = paths[i];
 
-                    if(verbose) {
-                        std::cout << "Current path: " << i << " - ";
-                        for(const int v : currentPath) {
-                            std::cout << v << ", ";
-                        }
-                        std::cout << std::endl;
-                    }
+                    LOG_TRACE("Current path: " << i << " - " << logList(currentPath));
 
-                    auto edges = pathGraphs[i].pathEdges(paths[i]);
-                    const bool success = pathGraphs[i].colorPath(edges);
+                    auto edges = pathEdges(currentPath);
+                    const bool success = timePhase(stats, &SolverStats::pathColoringTime, [&] {
+                        return colorPathDP(edges);
+                    });
 
                     if(success) {
-                        std::cout << "Coloring path successful" << std::endl;
-                        // export new constraints to tempgraph, original graph and
-                        // to all next path graphs
-                        for(size_t j = 0; j < currentPath.size()-1; j++) {
-                            const int v1 = currentPath[j], v2 = currentPath[j+1];
-                            const int color = pathGraphs[i].getEdge(v1, v2).color;
+                        LOG_DEBUG("Coloring path successful");
+                        // export new constraints to tempgraph and original graph,
+                        // which the next paths and parked fragments are part of
+                        for(const auto& edge : edges) {
+                            const int v1 = edge.v1(), v2 = edge.v2();
+                            const int color = edge.color();
                             tempGraph.addVertexConstraint(v1, color);
                             tempGraph.addVertexConstraint(v2, color);
                             addVertexConstraint(v1, color);
                             addVertexConstraint(v2, color);
-                            for(size_t w = i+1; w < pathGraphs.size(); w++) {
-                                pathGraphs[w].addVertexConstraint(v1, color);
-                                pathGraphs[w].addVertexConstraint(v2, color);
-                            }
                             // delete this path from graph
-                            pathGraphs[i].moveEdgeToAnotherGraph(outGraph, v1, v2);
+                            moveEdgeToAnotherGraph(outGraph, edge);
                         }
                     } else {
-                        std::cout << "Failed to color, moving to queue" << std::endl;
-                        AdjList a;
-                        auto* newGraph = new Graph(a);
-                        for(size_t j = 0; j < currentPath.size()-1; j++) {
-                            const int v1 = currentPath[j], v2 = currentPath[j+1];
-                            pathGraphs[i].moveEdgeToAnotherGraph(*newGraph, v1, v2);
+                        LOG_DEBUG("Failed to color, moving to queue");
+                        graphQueue.push_back(parkEdges(edges));
+                        if(stats) {
+                            stats->queuePushes++;
                         }
-                        graphQueue.push_back(newGraph);
                         justAddedToQueue = true;
-                        didSomething = true;
+                        didSomething = !failedAgain() || didSomething;
                     }
                 }
             } // else
         }
     }
+    // fragments left in queue were not colored, put them back
+    for(const auto& fragment : graphQueue) {
+        restoreEdges(fragment);
+    }
     graphQueue.clear();
-    if(adj.empty() && tempGraph.getAdj().empty()) {
+    if(core.empty() && tempGraph.isEmpty()) {
 
-        for(const auto& v : outGraph.getAdj()) {
-            for(const auto& e : v.second) {
-                if(e.color == 0) {
-                    return false;
-                }
+        const CsrGraph& outCore = outGraph.core;
+        for(int e = 0; e < outCore.edgeCapacity(); e++) {
+            if(outCore.isEdge(e) && outCore.edge(e).color == 0) {
+                return false;
             }
-            if(!outGraph.isOK(v.first)) {
+        }
+        for(int v = 0; v < outCore.vertexCapacity(); v++) {
+            if(outCore.isPresent(v) && !outGraph.isOK(outCore.idOf(v))) {
                 return false;
             }
         }
+        if(stats) {
+            stats->success = true;
+        }
         return true;
     }
     return false;
 }
 
 void Graph::print() const {
-    if(!verbose) {
+    if(!logEnabled(LogLevel::Trace)) {
         return;
     }
 
-    if(adj.empty() && constraints.empty()) {
-        std::cout << "~~EMPTY~~" << std::endl;
+    if(core.empty() && constraints.empty()) {
+        LOG_TRACE("~~EMPTY~~");
     } else {
-        for(const auto& v : adj) {
-            std::cout << v.first << ": ";
+        for(const auto& v : getAdj()) {
+            std::ostringstream line;
+            line << v.first << ": ";
             for(const auto& e : v.second) {
-                std::cout << e.v2 << "(" << e.color << "), ";
+                line << e.v2 << "(" << e.color << "), ";
             }
             if(constraints.find(v.first) != constraints.end()) {
-                std::cout << "constraints: [";
-                for(const int c : constraints.at(v.first)) {
-                    std::cout << c << ", ";
-                }
-                std::cout << "]";
+                line << "constraints: [" << logList(constraints.at(v.first).toVector()) << "]";
             }
-            std::cout << std::endl;
+            LOG_TRACE(line.str());
         }
     }
 }
 
 bool Graph::isOK(const int vertexIndex) {
-    if (areGaps(vertexIndex)) {
+    const ColorSummary& summary = summaryOf(vertexIndex);
+    if (summary.hasGaps() || summary.duplicates > 0) {
         return false;
     }
-    std::vector<int> seenColors;
-    for(const int c : getAllVertexConstraints(vertexIndex)) {
-        if(c == 0) {
-            return false;
-        }
-        for(const int seen : seenColors) {
-            if(seen == c) {
-                return false;
-            }
-        }
-        seenColors.emplace_back(c);
-    }
-    return true;
+    // color 0 can only come from a constraint
+    const int v = core.indexOf(vertexIndex);
+    return v == -1 || colorCounts.find(v, 0) == -1;
 }
 
 bool Graph::isEdge(const int v1, const int v2) {
-    if(adj.find(v1) == adj.end()) {
-        return false;
+    return edgeId(v1, v2) != -1;
+}
+
+void Graph::addVertexConstraint(const int vertexIndex, const int color) {
+    if(constraints[vertexIndex].insert(color)) {
+        const int v = core.internVertex(vertexIndex);
+        countColor(v, color, 0, 1);
+        if(!cyclesDirty) {
+            retouched.emplace_back(v);
+        }
     }
-    for(auto& edge : adj.at(v1)) {
-        if((edge.v1 == v1 && edge.v2 == v2) || (edge.v2 == v1 && edge.v1 == v2)) {
-            return true;
+}
+
+void Graph::clearVertexConstraints() {
+    for(const auto& kv : constraints) {
+        const int v = core.indexOf(kv.first);
+        if(v != -1) {
+            kv.second.forEach([this, v](const int c) { countColor(v, c, 0, -1); });
         }
     }
-    return false;
+    constraints.clear();
+    cyclesDirty = true;
 }
 
-void Graph::addVertexConstraint(const int vertexIndex, const int color) {
-    constraints[vertexIndex].insert(color);
+long long Graph::tightnessAt(const int v) const {
+    const ColorSummary& summary = summaryAt(v);
+    if(summary.empty()) {
+        return 0;
+    }
+    // colors the remaining edges can add besides filling gaps
+    const int missing = summary.highest - summary.lowest + 1 - summary.distinct;
+    const int slack = std::max(0, core.degree(v) - missing);
+    return (1LL << 40) + ((long long)summary.distinct << 8) - std::min(slack, 255);
 }
 
-std::vector<int> Graph::getAllVertexConstraints(const int vertexIndex) const {
-    std::set<int> result;
-    if(constraints.find(vertexIndex) != constraints.end()) {
-        // there are artificial constraints
-        for(const int c : constraints.at(vertexIndex)) {
-            result.insert(c);
-        }
+void Graph::copyConstraintsTo(Graph& other, const int vertexIndex) const {
+    const auto it = constraints.find(vertexIndex);
+    if(it != constraints.end()) {
+        it->second.forEach([&other, vertexIndex](const int c) {
+            other.addVertexConstraint(vertexIndex, c);
+        });
     }
+}
+
+ColorSet Graph::allColorsOf(const int vertexIndex) const {
+    // artificial constraints
+    const auto it = constraints.find(vertexIndex);
+    ColorSet result = it != constraints.end() ? it->second : ColorSet();
     // normal edges
-    for(const auto& e : adj.at(vertexIndex)) {
-        if(e.color != 0) {
-            result.insert(e.color);
+    const int v = core.indexOf(vertexIndex);
+    if(v != -1) {
+        for(int i = 0; i < core.degree(v); i++) {
+            const int color = core.edge(core.edgeAt(v, i)).color;
+            if(color != 0) {
+                result.insert(color);
+            }
         }
     }
-    return std::vector<int>(result.begin(), result.end());
+    return result;
+}
+
+std::vector<int> Graph::getAllVertexConstraints(const int vertexIndex) const {
+    return allColorsOf(vertexIndex).toVector();
 }
 
 void Graph::printGraphs(const Graph& temp, const Graph& out) const {
-    if(verbose) {
-        std::cout << "  Graph: " << std::endl;
+    if(logEnabled(LogLevel::Trace)) {
+        LOG_TRACE("  Graph: ");
         print();
-        std::cout << "  Tempgraph: " << std::endl;
+        LOG_TRACE("  Tempgraph: ");
         temp.print();
-        std::cout << "  Outgraph: " << std::endl;
+        LOG_TRACE("  Outgraph: ");
         out.print();
     }
 }
@@ -852,8 +1632,7 @@ std::vector<int> Graph::findConstrainedVerticesInCycle(std::vector<int> indices)
     indices.pop_back();
     std::vector<int> result;
     for(const int i : indices) {
-        std::vector<int> c = getAllVertexConstraints(i);
-        if(!c.empty()) {
+        if(!summaryOf(i).empty()) {
             result.emplace_back(i);
         }
     }
@@ -904,113 +1683,138 @@ std::vector<std::vector<int> > Graph::splitCycle(std::vector<int> cycle,
 }
 
 int Graph::numEdges() const {
-    int n = 0;
-    for(auto& v : adj) {
-        for(auto& e : v.second) {
-            n++;
-        }
+    return core.numEdges();
+}
+
+void Graph::touchPathStart(const int v) {
+    if(pathsDirty) {
+        return;
+    }
+    if((int)pathTouchedMark.size() <= v) {
+        pathTouchedMark.resize(core.vertexCapacity(), 0);
+    }
+    if(!pathTouchedMark[v]) {
+        pathTouchedMark[v] = 1;
+        pathTouched.emplace_back(v);
+    }
+}
+
+void Graph::queuePathStart(const int v) {
+    if((int)pathVersions.size() <= v) {
+        pathVersions.resize(core.vertexCapacity(), 0);
+    }
+    pathVersions[v]++;
+    const long long tightness = core.isPresent(v) ? tightnessAt(v) : 0;
+    if(tightness > 0) {
+        const unsigned tie = config && config->seed != 0 ? (unsigned)config->rng() : (unsigned)core.idOf(v);
+        pathStarts.push(PathStart{tightness, tie, v, pathVersions[v]});
     }
-    n /= 2; // each edge is counted twice
-    return n;
 }
 
 std::vector<int> Graph::findPath() {
-    // cleanup labels
-    labels.clear();
-    for(auto& keyval : adj) {
-        labels[keyval.first] = false;
+    // most constrained vertex, the smallest one of equally constrained
+    if(pathsDirty) {
+        pathStarts = std::priority_queue<PathStart>();
+        pathVersions.assign(core.vertexCapacity(), 0);
+        pathTouched.clear();
+        pathTouchedMark.assign(core.vertexCapacity(), 0);
+        for(int v = 0; v < core.vertexCapacity(); v++) {
+            queuePathStart(v);
+        }
+        pathsDirty = false;
+    } else {
+        for(const int v : pathTouched) {
+            pathTouchedMark[v] = 0;
+            queuePathStart(v);
+        }
+        pathTouched.clear();
+    }
+    while(!pathStarts.empty() && (pathStarts.top().version != pathVersions[pathStarts.top().v]
+        || !core.isPresent(pathStarts.top().v))) {
+        pathStarts.pop();
+    }
+    const int firstConstrained = pathStarts.empty() ? -1 : pathStarts.top().v;
+
+    // smallest vertex, searched only if nothing is constrained
+    int first = firstConstrained;
+    for(int v = 0; firstConstrained == -1 && v < core.vertexCapacity(); v++) {
+        if(core.isPresent(v) && (first == -1 || core.idOf(v) < core.idOf(first))) {
+            first = v;
+        }
     }
 
-    if(adj.empty()) {
+    if(first == -1) {
         return {};
     }
 
     std::vector<int> result;
 
-    // try to find a constrained vertex
-    bool found = false;
-    for(const auto& v : adj) {
-        const auto& cons = getAllVertexConstraints(v.first);
-        if(!cons.empty()) {
-            const int startingVertexIdx = v.first;
-
-            result = findPathRecur(startingVertexIdx, startingVertexIdx, true);
-            if(result.empty()) {
-                // not found, find a path ending with any vertex
-                // cleanup labels
-                for(auto& keyval : labels) {
-                    keyval.second = false;
-                }
-                result = findPathRecur(startingVertexIdx, startingVertexIdx, false);
-                std::cout << "Found a path constrained on one end" << std::endl;
-            } else {
-                if(verbose) std::cout << "Found a path constrained on both ends" 
-                                      << std::endl;
-            }
-            found = true;
-            break;
+    // try to start with a constrained vertex
+    if(firstConstrained != -1) {
+        result = findPathFrom(firstConstrained, true);
+        if(result.empty()) {
+            // not found, find a path ending with any vertex
+            result = findPathFrom(firstConstrained, false);
+            LOG_DEBUG("Found a path constrained on one end");
+        } else {
+            LOG_TRACE("Found a path constrained on both ends");
         }
-    }
-    
-    if(!found) {
+    } else {
         // didn't find constrained vertex, start with any
-        const int startingVertexIdx = adj.begin()->first;
-        result = findPathRecur(startingVertexIdx, startingVertexIdx, false);
+        result = findPathFrom(first, false);
     }  
 
     if(result.empty()) {
-        std::cout << "No path found" << std::endl;
+        LOG_DEBUG("No path found");
     } else {
-        std::reverse(result.begin(), result.end());
-
-        std::cout<< "Found path: ";
-        for(const int a : result) {
-            std::cout << a << ", ";
-        }
-        std::cout << std::endl;
-    }
-
-    // cleanup labels
-    for(auto& keyval : labels) {
-        keyval.second = false;
+        LOG_DEBUG("Found path: " << logList(result));
     }
     return result;
 }
 
-std::vector<int> Graph::findPathRecur(const int startingVertexIdx, 
-    const int currentVertexIdx, const bool mustEndWithConstrained) {
-    labels[currentVertexIdx] = true;
-
-    const auto& cons = getAllVertexConstraints(currentVertexIdx);
-    if(startingVertexIdx != currentVertexIdx && mustEndWithConstrained && !cons.empty()) {
-        return {currentVertexIdx};
-    }
-
-    const auto& edges = adj.at(currentVertexIdx);
-
-    if(startingVertexIdx != currentVertexIdx && edges.size() == 1) {
-        // leaf found
-        if(mustEndWithConstrained && cons.empty()) {
-            return {};
-        } else {
-            return {currentVertexIdx};
+std::vector<int> Graph::findPathFrom(const int start, const bool mustEndWithConstrained) {
+    struct Frame {
+        int v;
+        int next;
+    };
+    std::vector<Frame> stack;
+    const auto pathOnStack = [this, &stack]() {
+        std::vector<int> result;
+        result.reserve(stack.size());
+        for(const Frame& f : stack) {
+            result.emplace_back(core.idOf(f.v));
         }
-    }
-
-    for(auto& edge : edges) {
-        
-        const int neighbourIdx = edge.v2;
-        if(labels.at(neighbourIdx)) {
+        return result;
+    };
+
+    startVisit();
+    visit(start);
+    stack.push_back(Frame{start, 0});
+    while(!stack.empty()) {
+        Frame& frame = stack.back();
+        if(frame.next == core.degree(frame.v)) {
+            stack.pop_back();
             continue;
         }
+        const int neighbour = core.neighbour(frame.v, frame.next++);
+        if(isVisited(neighbour)) {
+            continue;
+        }
+        visit(neighbour);
+        stack.push_back(Frame{neighbour, 0});
 
-        auto result = findPathRecur(startingVertexIdx, neighbourIdx,
-            mustEndWithConstrained);
-        if(!result.empty()) {
-            result.emplace_back(currentVertexIdx);
-            // return the first branch since we're looking just for paths
-            return result;
+        const bool constrained = !summaryAt(neighbour).empty();
+        if(mustEndWithConstrained && constrained) {
+            return pathOnStack();
+        }
+        if(core.degree(neighbour) == 1) {
+            // leaf found
+            if(mustEndWithConstrained && !constrained) {
+                stack.pop_back();
+            } else {
+                return pathOnStack();
+            }
         }
     }
     return {};
-}
\ No newline at end of file
+}
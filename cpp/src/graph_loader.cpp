@@ -0,0 +1,179 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include "../include/graph_loader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * When number of threads is picked automatically, each gets at least this many bytes.
+ */
+const size_t MIN_CHUNK_SIZE = 1 << 20;
+
+inline bool isBlank(const char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * Scan integer at p. On success store it in value, advance p and return true.
+ */
+inline bool scanInt(const char*& p, const char* end, int& value) {
+    const char* q = p;
+    bool negative = false;
+    if(q != end && (*q == '-' || *q == '+')) {
+        negative = *q == '-';
+        q++;
+    }
+    if(q == end || *q < '0' || *q > '9') {
+        return false;
+    }
+    long long result = 0;
+    while(q != end && *q >= '0' && *q <= '9') {
+        result = result * 10 + (*q - '0');
+        q++;
+    }
+    value = (int)(negative ? -result : result);
+    p = q;
+    return true;
+}
+
+/**
+ * Parse whole lines in [begin, end) into rows.
+ */
+void parseChunk(const char* begin, const char* end, AdjacencyRows& rows) {
+    const char* p = begin;
+    while(p < end) {
+        while(p < end && isBlank(*p)) {
+            p++;
+        }
+        int value;
+        if(scanInt(p, end, value)) {
+            rows.rowIds.emplace_back(value);
+            while(true) {
+                while(p < end && isBlank(*p)) {
+                    p++;
+                }
+                if(!scanInt(p, end, value)) {
+                    break;
+                }
+                rows.neighbourIds.emplace_back(value);
+            }
+            rows.rowOffsets.emplace_back(rows.neighbourIds.size());
+        }
+        const char* newline = (const char*)memchr(p, '\n', end - p);
+        p = newline ? newline + 1 : end;
+    }
+}
+
+}
+
+MappedFile::MappedFile(const std::string& fileName) {
+    const int fd = ::open(fileName.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return;
+    }
+    struct stat st;
+    if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        length = st.st_size;
+        if(length == 0) {
+            open = true;
+        } else {
+            void* addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(addr != MAP_FAILED) {
+                madvise(addr, length, MADV_SEQUENTIAL);
+                begin = (const char*)addr;
+                mapped = open = true;
+            }
+        }
+    }
+    if(!open) {
+        // not a regular file or mapping failed, read it
+        char chunk[1 << 16];
+        ssize_t n;
+        while((n = read(fd, chunk, sizeof(chunk))) > 0) {
+            buffer.insert(buffer.end(), chunk, chunk + n);
+        }
+        begin = buffer.data();
+        length = buffer.size();
+        open = n == 0;
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if(mapped) {
+        munmap((void*)begin, length);
+    }
+}
+
+void parseAdjacencyRows(const char* begin, const char* end, AdjacencyRows& rows,
+    unsigned numThreads) {
+
+    const size_t size = end - begin;
+    if(numThreads == 0) {
+        numThreads = (unsigned)std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+            size / MIN_CHUNK_SIZE);
+    }
+    numThreads = (unsigned)std::max<size_t>(1, std::min<size_t>(numThreads, size));
+
+    // line-aligned chunk boundaries
+    std::vector<const char*> bounds{begin};
+    for(unsigned t = 1; t < numThreads; t++) {
+        const char* p = std::max(bounds.back(), begin + size * t / numThreads);
+        const char* newline = (const char*)memchr(p, '\n', end - p);
+        bounds.emplace_back(newline ? newline + 1 : end);
+    }
+    bounds.emplace_back(end);
+
+    std::vector<AdjacencyRows> parts(numThreads);
+    if(numThreads == 1) {
+        parseChunk(begin, end, parts[0]);
+    } else {
+        std::vector<std::thread> workers;
+        for(unsigned t = 0; t < numThreads; t++) {
+            workers.emplace_back(parseChunk, bounds[t], bounds[t+1], std::ref(parts[t]));
+        }
+        for(auto& w : workers) {
+            w.join();
+        }
+    }
+
+    // concatenate parts in input order
+    size_t numRows = rows.rowIds.size(), numNeighbours = rows.neighbourIds.size();
+    for(const auto& part : parts) {
+        numRows += part.rowIds.size();
+        numNeighbours += part.neighbourIds.size();
+    }
+    rows.rowIds.reserve(numRows);
+    rows.rowOffsets.reserve(numRows + 1);
+    rows.neighbourIds.reserve(numNeighbours);
+    for(const auto& part : parts) {
+        const size_t base = rows.neighbourIds.size();
+        rows.rowIds.insert(rows.rowIds.end(), part.rowIds.begin(), part.rowIds.end());
+        for(size_t r = 1; r < part.rowOffsets.size(); r++) {
+            rows.rowOffsets.emplace_back(base + part.rowOffsets[r]);
+        }
+        rows.neighbourIds.insert(rows.neighbourIds.end(), part.neighbourIds.begin(),
+            part.neighbourIds.end());
+    }
+}
+
+bool loadAdjacencyRows(const std::string& fileName, AdjacencyRows& rows, unsigned numThreads) {
+    MappedFile file(fileName);
+    if(!file.isOpen()) {
+        return false;
+    }
+    parseAdjacencyRows(file.data(), file.data() + file.size(), rows, numThreads);
+    return true;
+}
@@ -0,0 +1,26 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include "../include/graph_pool.h"
+
+Graph& GraphPool::acquire(SolverStats* stats, SolverConfig* config) {
+    Graph* graph;
+    if(unused.empty()) {
+        AdjList a;
+        graphs.emplace_back(a);
+        graph = &graphs.back();
+    } else {
+        graph = unused.back();
+        unused.pop_back();
+    }
+    graph->setStats(stats);
+    graph->setConfig(config);
+    return *graph;
+}
+
+void GraphPool::release(Graph& graph) {
+    graph.clear();
+    unused.emplace_back(&graph);
+}
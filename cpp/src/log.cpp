@@ -0,0 +1,74 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include "../include/log.h"
+
+#include <mutex>
+
+LogLevel logLevel = LogLevel::Info;
+
+namespace {
+
+/**
+ * Buffered messages are written out once they exceed this size.
+ */
+const size_t LOG_BUFFER_SIZE = 1 << 16;
+
+std::mutex logMutex;
+std::string logBuffer;
+std::FILE* logSink = nullptr;
+
+void flushLocked() {
+    if(!logBuffer.empty()) {
+        if(logSink) {
+            std::fwrite(logBuffer.data(), 1, logBuffer.size(), logSink);
+            std::fflush(logSink);
+        }
+        logBuffer.clear();
+    }
+}
+
+/**
+ * Flushes the log at exit.
+ */
+struct LogFlusher {
+    ~LogFlusher() { flushLog(); }
+} logFlusher;
+
+}
+
+bool parseLogLevel(const std::string& name, LogLevel& level) {
+    if(name == "error") {
+        level = LogLevel::Error;
+    } else if(name == "info") {
+        level = LogLevel::Info;
+    } else if(name == "debug") {
+        level = LogLevel::Debug;
+    } else if(name == "trace") {
+        level = LogLevel::Trace;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void logWrite(const LogLevel level, const std::string& line) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    logBuffer += line;
+    if(level == LogLevel::Error || logBuffer.size() >= LOG_BUFFER_SIZE) {
+        flushLocked();
+    }
+}
+
+void flushLog() {
+    std::lock_guard<std::mutex> lock(logMutex);
+    flushLocked();
+}
+
+void setLogSink(std::FILE* sink) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    flushLocked();
+    logSink = sink;
+}
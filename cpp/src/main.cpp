@@ -3,56 +3,162 @@
  *  @author Michal Zakowski
  */
 
+#include <csignal>
 #include <iostream>
 #include "../include/graph.h"
+#include "../include/component_coloring.h"
+#include "../include/portfolio.h"
+#include "../include/exact_solver.h"
+#include "../include/server.h"
+
+/**
+ * Check if name ends with given extension.
+ */
+static bool hasExtension(const std::string& name, const std::string& extension) {
+    return name.size() >= extension.size()
+        && name.compare(name.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+/**
+ * Check if text is a non-negative decimal number.
+ */
+static bool isNumber(const std::string& text) {
+    return !text.empty() && text.find_first_not_of("0123456789") == std::string::npos;
+}
+
+/**
+ * Save graph in format picked by extension of output file:
+ * .gcb - binary, .adj - adjacency list, otherwise .dot and .txt.
+ */
+static void save(const Graph& graph, const std::string& fileName) {
+    if(hasExtension(fileName, ".gcb")) {
+        if(!graph.serializeBinary(fileName)) {
+            LOG_ERROR("Cannot write " << fileName);
+        }
+    } else if(hasExtension(fileName, ".adj")) {
+        graph.serializeAdjacency(fileName);
+    } else {
+        graph.serialize(fileName);
+    }
+}
+
+/**
+ * Server stopped by SIGINT and SIGTERM.
+ */
+static Server* activeServer = nullptr;
+
+static void stopServer(int) {
+    if(activeServer) {
+        activeServer->stop();
+    }
+}
+
+/**
+ * Serve requests on socket until interrupted.
+ */
+static int serve(const std::string& socketPath, const ServerOptions& options) {
+    Server server(options);
+    if(!server.listen(socketPath)) {
+        return 1;
+    }
+    activeServer = &server;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+    LOG_INFO("Serving on " << socketPath);
+    server.run();
+    activeServer = nullptr;
+    LOG_INFO("Stopped serving on " << socketPath);
+    flushLog();
+    return 0;
+}
 
 /**
  * Starting point of the program
  */
 int main(int argc, char *argv[]) {
-    if (argc < 3 || argc > 5)
-        std::cout<<"usage: "<< argv[0] <<" <input file> <output file> [--dontcolor] [--verbose]" << std::endl;
-    else {
-
-        bool dontcolor = false;
-        std::vector<std::string> flags;
-        if(argc == 4) {
-            flags.emplace_back(std::string(argv[3]));
-        }
-        if(argc == 5) {
-            flags.emplace_back(std::string(argv[3]));
-            flags.emplace_back(std::string(argv[4]));
-        }
+    if (argc < 3) {
+        std::cout<<"usage: "<< argv[0] <<" <input file> <output file> [--dontcolor] [--verbose]"
+            " [--log <error|info|debug|trace>] [--stats <file>] [--threads <n>]"
+            " [--portfolio <n>] [--exact]" << std::endl
+            << "       " << argv[0] << " --serve <socket path> [--threads <n>] [--queue <n>]"
+            " [--log <error|info|debug|trace>]" << std::endl;
+        return 0;
+    }
 
-        for(const std::string flag : flags) {
-            if(flag == "--dontcolor") {
-                dontcolor = true;
-            } else if(flag == "--verbose") {
-                verbose = true;
-            } else {
-                std::cout << "Invalid flag";
-                return 1;
-            }
+    setLogSink(stderr);
+    bool dontcolor = false;
+    std::string statsFile;
+    unsigned numThreads = 1;
+    unsigned numInstances = 1;
+    bool exact = false;
+    const bool serving = std::string(argv[1]) == "--serve";
+    ServerOptions serverOptions;
+    for(int i = 3; i < argc; i++) {
+        const std::string flag(argv[i]);
+        if(flag == "--dontcolor") {
+            dontcolor = true;
+        } else if(flag == "--verbose") {
+            logLevel = VERBOSE_LOG_LEVEL;
+        } else if(flag == "--log" && i + 1 < argc && parseLogLevel(argv[i+1], logLevel)) {
+            i++;
+        } else if(flag == "--stats" && i + 1 < argc) {
+            statsFile = argv[++i];
+        } else if(flag == "--threads" && i + 1 < argc && isNumber(argv[i+1])) {
+            numThreads = (unsigned)std::stoul(argv[++i]);
+        } else if(flag == "--portfolio" && i + 1 < argc && isNumber(argv[i+1])) {
+            numInstances = (unsigned)std::stoul(argv[++i]);
+        } else if(flag == "--exact") {
+            exact = true;
+        } else if(flag == "--queue" && i + 1 < argc && isNumber(argv[i+1])
+                && std::stoul(argv[i+1]) > 0) {
+            serverOptions.maxQueued = std::stoul(argv[++i]);
+        } else {
+            std::cout << "Invalid flag " << flag << std::endl;
+            return 1;
         }
+    }
 
-        Graph graph(argv[1]);
+    if(serving) {
+        serverOptions.numThreads = numThreads;
+        return serve(argv[2], serverOptions);
+    }
 
-        if(dontcolor) {
-            graph.serialize(argv[2]);
+    Graph graph(argv[1]);
+
+    if(dontcolor) {
+        save(graph, argv[2]);
+    } else {
+        AdjList a;
+        auto outGraph = Graph(a);
+        SolverStats stats;
+        SolverStats* solverStats = statsFile.empty() ? nullptr : &stats;
+        ExactResult exactResult = ExactResult::Colored;
+        if(exact) {
+            exactResult = colorExact(graph, outGraph, ExactLimits(), solverStats);
+        }
+        const bool success = exact ? exactResult == ExactResult::Colored
+            : numInstances > 1
+            ? colorPortfolio(graph, outGraph, numInstances, numThreads, solverStats)
+            : colorComponents(graph, outGraph, numThreads, solverStats);
+        flushLog();
+        if(!statsFile.empty() && !stats.writeJson(statsFile)) {
+            LOG_ERROR("Cannot write " << statsFile);
+        }
+        if(exactResult == ExactResult::Infeasible) {
+            std::cout << std::endl << " ~~~~~~ GRAPH HAS NO INTERVAL COLORING ~~~~~~ "
+                    << std::endl;
+        } else if(exactResult == ExactResult::LimitReached) {
+            std::cout << std::endl << " ~~~~~~ SEARCH LIMIT REACHED, NOTHING PROVEN ~~~~~~ "
+                    << std::endl;
+        } else if(!success) {
+            std::cout << std::endl << " ~~~~~~ FAILED TO COLOR GRAPH :( ~~~~~~ " 
+                    << std::endl;
         } else {
-            AdjList a;
-            auto outGraph = Graph(a);
-            const bool success = graph.color(outGraph);
-            if(!success) {
-                std::cout << std::endl << " ~~~~~~ FAILED TO COLOR GRAPH :( ~~~~~~ " 
-                        << std::endl;
-            } else {
-                std::cout << std::endl << " ~~~~~~ SUCCESS :) ~~~~~~ " << std::endl;
-            }
-            outGraph.print();
-            outGraph.serialize(argv[2]);
+            std::cout << std::endl << " ~~~~~~ SUCCESS :) ~~~~~~ " << std::endl;
         }
+        outGraph.print();
+        save(outGraph, argv[2]);
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,156 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include "../include/pair_table.h"
+
+#include <algorithm>
+
+const uint64_t PairTable::EMPTY;
+const uint64_t PairTable::ERASED;
+
+uint64_t PairTable::key(const int a, const int b) {
+    return ((uint64_t)(uint32_t)a << 32) | (uint32_t)b;
+}
+
+size_t PairTable::hash(uint64_t key) {
+    // splitmix64 finalizer
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return (size_t)key;
+}
+
+size_t PairTable::slotOf(const uint64_t k) const {
+    if(keys.empty()) {
+        return keys.size();
+    }
+    const size_t mask = keys.size() - 1;
+    for(size_t i = hash(k) & mask; ; i = (i + 1) & mask) {
+        if(keys[i] == k) {
+            return i;
+        }
+        if(keys[i] == EMPTY) {
+            return keys.size();
+        }
+    }
+}
+
+int PairTable::find(const int a, const int b) const {
+    const size_t i = slotOf(key(a, b));
+    return i == keys.size() ? -1 : values[i];
+}
+
+int PairTable::add(const int a, const int b, const int delta) {
+    const size_t i = slotOf(key(a, b));
+    if(i == keys.size()) {
+        if(delta != 0) {
+            insert(a, b, delta);
+        }
+        return delta;
+    }
+    values[i] += delta;
+    const int value = values[i];
+    if(value == 0) {
+        keys[i] = ERASED;
+        live--;
+    }
+    return value;
+}
+
+void PairTable::insert(const int a, const int b, const int value) {
+    if((used + 1) * 4 > keys.size() * 3) {
+        grow();
+    }
+    const uint64_t k = key(a, b);
+    const size_t mask = keys.size() - 1;
+    for(size_t i = hash(k) & mask; ; i = (i + 1) & mask) {
+        if(keys[i] == EMPTY || keys[i] == ERASED) {
+            if(keys[i] == EMPTY) {
+                used++;
+            }
+            keys[i] = k;
+            values[i] = value;
+            live++;
+            return;
+        }
+    }
+}
+
+void PairTable::erase(const int a, const int b) {
+    const size_t i = slotOf(key(a, b));
+    if(i != keys.size()) {
+        keys[i] = ERASED;
+        live--;
+    }
+}
+
+void PairTable::clear() {
+    std::fill(keys.begin(), keys.end(), EMPTY);
+    used = 0;
+    live = 0;
+}
+
+void PairTable::reserve(const size_t numEntries) {
+    if(numEntries * 4 <= keys.size() * 3) {
+        return;
+    }
+    size_t capacity = 16;
+    while(numEntries * 4 > capacity * 3) {
+        capacity *= 2;
+    }
+
+    std::vector<uint64_t> oldKeys(capacity, EMPTY);
+    std::vector<int> oldValues(capacity, -1);
+    oldKeys.swap(keys);
+    oldValues.swap(values);
+    used = live = 0;
+
+    const size_t mask = keys.size() - 1;
+    for(size_t j = 0; j < oldKeys.size(); j++) {
+        if(oldKeys[j] == EMPTY || oldKeys[j] == ERASED) {
+            continue;
+        }
+        size_t i = hash(oldKeys[j]) & mask;
+        while(keys[i] != EMPTY) {
+            i = (i + 1) & mask;
+        }
+        keys[i] = oldKeys[j];
+        values[i] = oldValues[j];
+        used++;
+        live++;
+    }
+}
+
+void PairTable::grow() {
+    // rehashing also drops tombstones, so only grow when live entries need it
+    const size_t target = std::max<size_t>(live + 1, 8);
+    if(target * 2 <= keys.size()) {
+        std::vector<uint64_t> oldKeys;
+        std::vector<int> oldValues;
+        oldKeys.swap(keys);
+        oldValues.swap(values);
+        keys.assign(oldKeys.size(), EMPTY);
+        values.assign(oldValues.size(), -1);
+        used = live = 0;
+        const size_t mask = keys.size() - 1;
+        for(size_t j = 0; j < oldKeys.size(); j++) {
+            if(oldKeys[j] == EMPTY || oldKeys[j] == ERASED) {
+                continue;
+            }
+            size_t i = hash(oldKeys[j]) & mask;
+            while(keys[i] != EMPTY) {
+                i = (i + 1) & mask;
+            }
+            keys[i] = oldKeys[j];
+            values[i] = oldValues[j];
+            used++;
+            live++;
+        }
+    } else {
+        reserve(target * 2);
+    }
+}
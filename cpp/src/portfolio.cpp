@@ -0,0 +1,61 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include "../include/portfolio.h"
+#include "../include/component_coloring.h"
+#include "../include/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+bool colorPortfolio(Graph& graph, Graph& outGraph, unsigned numInstances,
+    unsigned numThreads, SolverStats* stats, const std::atomic<bool>* callerCancelled) {
+
+    const auto start = std::chrono::steady_clock::now();
+    numInstances = std::max(1u, numInstances);
+
+    std::atomic<bool> cancelled(false);
+    std::atomic<int> winner(-1);
+    std::vector<Graph> inputs(numInstances, graph);
+    std::vector<Graph> outputs;
+    std::vector<SolverStats> instanceStats(numInstances);
+    std::vector<SolverConfig> configs(numInstances);
+    std::vector<char> success(numInstances, 0);
+    for(unsigned i = 0; i < numInstances; i++) {
+        AdjList a;
+        outputs.emplace_back(a);
+        configs[i].reseed(i);
+        configs[i].reach = 2 + i % 2;
+        configs[i].cancelled = &cancelled;
+        configs[i].callerCancelled = callerCancelled;
+    }
+
+    {
+        ThreadPool pool(numInstances);
+        for(unsigned i = 0; i < numInstances; i++) {
+            pool.submit([&, i] {
+                success[i] = colorComponents(inputs[i], outputs[i], numThreads,
+                    stats ? &instanceStats[i] : nullptr, &configs[i]);
+                int none = -1;
+                if(success[i] && winner.compare_exchange_strong(none, (int)i)) {
+                    LOG_DEBUG("Portfolio instance " << i << " colored the graph first");
+                    cancelled = true;
+                }
+            });
+        }
+        pool.wait();
+    }
+
+    const int chosen = std::max(0, winner.load());
+    graph = std::move(inputs[chosen]);
+    outputs[chosen].moveAllEdgesToAnotherGraph(outGraph);
+    if(stats) {
+        *stats = instanceStats[chosen];
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        stats->totalTime = elapsed.count();
+    }
+    return success[chosen];
+}
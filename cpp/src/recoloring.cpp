@@ -0,0 +1,239 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include "../include/recoloring.h"
+#include "../include/component_coloring.h"
+#include "../include/exact_solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <unordered_map>
+
+namespace {
+
+/**
+ * Time given to exact search of components the heuristic failed to color again.
+ */
+const double exactSeconds = 1;
+
+Graph emptyGraph() {
+    AdjList a;
+    return Graph(a);
+}
+
+/**
+ * Colors that can be added at vertex leaving no gap: the missing color if
+ * exactly one is missing, otherwise the colors next to the interval.
+ * Nothing if colors at vertex cannot be fixed by one more color.
+ */
+std::vector<int> extensionsOf(const Graph& graph, const int vertexIndex) {
+    const ColorSummary& summary = graph.summaryOf(vertexIndex);
+    const int missing = summary.highest - summary.lowest + 1 - summary.distinct;
+    std::vector<int> colors;
+    if(summary.duplicates > 0 || missing > 1) {
+        return colors;
+    }
+    if(missing == 1) {
+        std::vector<int> present = graph.getAllVertexConstraints(vertexIndex);
+        std::sort(present.begin(), present.end());
+        for(size_t i = 1; i < present.size(); i++) {
+            if(present[i] - present[i - 1] == 2) {
+                colors.push_back(present[i] - 1);
+            }
+        }
+        return colors;
+    }
+    if(summary.lowest > 1) {
+        colors.push_back(summary.lowest - 1);
+    }
+    colors.push_back(summary.highest + 1);
+    return colors;
+}
+
+/**
+ * Give uncolored edge v1-v2 a color extending intervals at both its ends.
+ * Return false if there is no such color.
+ */
+bool colorDirectly(Graph& graph, const int v1, const int v2) {
+    const bool free1 = graph.summaryOf(v1).empty(), free2 = graph.summaryOf(v2).empty();
+    if(free1 && free2) {
+        graph.colorEdge(v1, v2, 1);
+        return true;
+    }
+    const std::vector<int> colors1 = extensionsOf(graph, v1), colors2 = extensionsOf(graph, v2);
+    for(const int color : free1 ? colors2 : colors1) {
+        if(free2 || std::find(colors2.begin(), colors2.end(), color) != colors2.end()) {
+            graph.colorEdge(v1, v2, color);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Color again all edges with both ends at most radius hops from touched
+ * vertices. Colors of edges leaving that ball are constraints of their ends.
+ * Closed is set if the ball has no such edges, i.e. it covers whole components,
+ * which are then colored with colorComponents and, where that fails, by exact
+ * search. Colors are written to graph
+ * only if the ball was colored properly.
+ */
+bool recolorBall(Graph& graph, const std::vector<int>& touched, const int radius,
+        const unsigned numThreads, SolverStats* stats, bool& closed) {
+    // breadth-first search, ball doubles as the queue
+    std::unordered_map<int, int> depth;
+    std::vector<int> ball;
+    for(const int v : touched) {
+        if(depth.emplace(v, 0).second) {
+            ball.push_back(v);
+        }
+    }
+    for(size_t next = 0; next < ball.size(); next++) {
+        const int v = ball[next];
+        const int d = depth[v];
+        if(d == radius) {
+            continue;
+        }
+        for(const Edge& e : graph.edgesOf(v)) {
+            if(depth.emplace(e.v2, d + 1).second) {
+                ball.push_back(e.v2);
+            }
+        }
+    }
+
+    Graph inner = emptyGraph();
+    Graph out = emptyGraph();
+    std::vector<Edge> innerEdges;
+    closed = true;
+    for(const int v : ball) {
+        for(const Edge& e : graph.edgesOf(v)) {
+            if(depth.count(e.v2)) {
+                if(v < e.v2) {
+                    innerEdges.emplace_back(v, e.v2);
+                    inner.addEdge(innerEdges.back());
+                }
+            } else {
+                // out takes constraints too, so that color checks them
+                inner.addVertexConstraint(v, e.color);
+                out.addVertexConstraint(v, e.color);
+                closed = false;
+            }
+        }
+    }
+    if(inner.isEmpty()) {
+        return closed;
+    }
+    LOG_DEBUG("Recoloring " << inner.numEdges() << " edges within " << radius
+        << " hops of " << touched.size() << " touched vertices");
+
+    SolverStats innerStats;
+    bool success;
+    if(closed) {
+        success = colorComponents(inner, out, numThreads, stats ? &innerStats : nullptr);
+        if(!success) {
+            // failed components are split between inner and out, start over
+            inner = emptyGraph();
+            out = emptyGraph();
+            for(const Edge& e : innerEdges) {
+                inner.addEdge(e);
+            }
+            ExactLimits limits;
+            limits.maxSeconds = exactSeconds;
+            SolverStats exactStats;
+            success = colorExact(inner, out, limits, stats ? &exactStats : nullptr)
+                == ExactResult::Colored;
+            innerStats.add(exactStats);
+        }
+    } else {
+        inner.setStats(stats ? &innerStats : nullptr);
+        success = inner.color(out);
+    }
+    if(stats) {
+        stats->add(innerStats);
+    }
+    if(!success) {
+        return false;
+    }
+    for(const auto& kv : out.getAdj()) {
+        for(const Edge& e : kv.second) {
+            if(e.v1 < e.v2) {
+                graph.colorEdge(e.v1, e.v2, e.color);
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Check that every edge at touched vertices is colored and there are no gaps.
+ */
+bool coloredAt(Graph& graph, const std::vector<int>& touched) {
+    for(const int v : touched) {
+        if(!graph.isOK(v)) {
+            return false;
+        }
+        for(const Edge& e : graph.edgesOf(v)) {
+            if(e.color == 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}
+
+bool recolor(Graph& graph, const std::vector<EdgeEdit>& edits, const unsigned numThreads,
+        SolverStats* stats) {
+    const auto start = std::chrono::steady_clock::now();
+    // the solver leaves colors it gave as constraints, they would pin old colors
+    graph.clearVertexConstraints();
+
+    Graph removed = emptyGraph();
+    std::vector<int> touched;
+    for(const auto& edit : edits) {
+        if(edit.v1 == edit.v2 || graph.isEdge(edit.v1, edit.v2) == (edit.kind == EdgeEdit::Insert)) {
+            continue;
+        }
+        if(edit.kind == EdgeEdit::Insert) {
+            graph.addEdge(Edge(edit.v1, edit.v2));
+        } else {
+            graph.moveEdgeToAnotherGraph(removed, edit.v1, edit.v2);
+        }
+        touched.push_back(edit.v1);
+        touched.push_back(edit.v2);
+    }
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+    for(const auto& edit : edits) {
+        if(edit.kind == EdgeEdit::Insert && edit.v1 != edit.v2 && graph.isEdge(edit.v1, edit.v2)
+                && graph.getEdge(edit.v1, edit.v2).color == 0) {
+            colorDirectly(graph, edit.v1, edit.v2);
+        }
+    }
+
+    bool success = coloredAt(graph, touched);
+    bool closed = false;
+    for(const int radius : {1, 2, 4, INT_MAX}) {
+        if(success || closed) {
+            break;
+        }
+        success = recolorBall(graph, touched, radius, numThreads, stats, closed);
+    }
+    if(!success) {
+        LOG_DEBUG("Failed to repair coloring after " << edits.size() << " edits");
+    }
+
+    if(stats) {
+        stats->vertices = graph.numVertices();
+        stats->edges = graph.numEdges();
+        stats->success = success;
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        stats->totalTime = elapsed.count();
+    }
+    return success;
+}
@@ -0,0 +1,422 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include "../include/server.h"
+#include "../include/binary_format.h"
+#include "../include/component_coloring.h"
+#include "../include/graph.h"
+#include "../include/log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <sstream>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * Outcome of looking for a request in buffered input.
+ */
+enum class Framing { Complete, Incomplete, Malformed };
+
+const std::string binaryPrefix = "binary ";
+
+/**
+ * Find request starting at pos of buffer, skipping blank lines. When it is
+ * complete, copy it to request and move pos past it, otherwise pos stays at
+ * its start. Text is searched for its end from scanned on, which is moved to
+ * the end of buffer, so that a long request is scanned only once. Once input
+ * has ended (atEnd), text without the final empty line is a request too.
+ */
+Framing nextRequest(const std::string& buffer, size_t& pos, size_t& scanned, const bool atEnd,
+        const size_t maxBytes, std::string& request, std::string& error) {
+    while(pos < buffer.size() && (buffer[pos] == '\n' || buffer[pos] == '\r')) {
+        pos++;
+    }
+    scanned = std::max(scanned, pos);
+    if(pos == buffer.size()) {
+        return Framing::Incomplete;
+    }
+
+    const size_t prefix = std::min(buffer.size() - pos, binaryPrefix.size());
+    if(buffer.compare(pos, prefix, binaryPrefix, 0, prefix) == 0) {
+        const size_t eol = buffer.find('\n', pos);
+        if(eol == std::string::npos) {
+            error = "incomplete binary request";
+            return atEnd ? Framing::Malformed : Framing::Incomplete;
+        }
+        const size_t start = pos + binaryPrefix.size();
+        const std::string length = buffer.substr(start, eol - start);
+        if(length.empty() || length.size() > 18
+                || length.find_first_not_of("0123456789") != std::string::npos) {
+            error = "invalid length of binary request";
+            return Framing::Malformed;
+        }
+        const size_t size = (size_t)std::stoull(length);
+        if(size > maxBytes) {
+            error = "request too long";
+            return Framing::Malformed;
+        }
+        if(buffer.size() - eol - 1 < size) {
+            error = "incomplete binary request";
+            return atEnd ? Framing::Malformed : Framing::Incomplete;
+        }
+        request.assign(buffer, eol + 1, size);
+        pos = eol + 1 + size;
+        scanned = pos;
+        return Framing::Complete;
+    }
+
+    // the empty line may start at the last character scanned before
+    const size_t end = buffer.find("\n\n", std::max(pos, scanned > 0 ? scanned - 1 : 0));
+    if(end == std::string::npos) {
+        scanned = buffer.size();
+        if(buffer.size() - pos > maxBytes) {
+            error = "request too long";
+            return Framing::Malformed;
+        }
+        if(!atEnd) {
+            return Framing::Incomplete;
+        }
+        request.assign(buffer, pos, std::string::npos);
+        pos = buffer.size();
+        return Framing::Complete;
+    }
+    request.assign(buffer, pos, end + 1 - pos);
+    pos = end + 2;
+    scanned = pos;
+    return Framing::Complete;
+}
+
+/**
+ * Color graph in request and format the answer.
+ */
+std::string colorRequest(const std::string& request) {
+    if(isBinaryGraph(request.data(), request.size())
+            && !BinaryGraphView(request.data(), request.size()).isValid()) {
+        return "error invalid binary graph\n\n";
+    }
+    Graph graph(request.data(), request.size());
+    AdjList a;
+    Graph outGraph(a);
+    const bool success = colorComponents(graph, outGraph, 1);
+
+    std::ostringstream os;
+    os << (success ? "ok " : "failed ") << outGraph.numEdges() + graph.numEdges() << "\n";
+    for(const Graph* g : {&outGraph, &graph}) {
+        for(const auto& kv : g->getAdj()) {
+            for(const auto& e : kv.second) {
+                if(e.v1 < e.v2) {
+                    os << e.v1 << " " << e.v2 << " " << e.color << "\n";
+                }
+            }
+        }
+    }
+    os << "\n";
+    return os.str();
+}
+
+}
+
+/**
+ * Client socket with answers waiting for earlier ones. Only its reader reads
+ * and writes the socket, workers leave answers here and wake it.
+ */
+struct Server::Connection {
+    explicit Connection(const int fd) : fd(fd) {
+        if(pipe2(wakeFds, O_NONBLOCK | O_CLOEXEC) != 0) {
+            wakeFds[0] = wakeFds[1] = -1;
+        }
+    }
+    ~Connection() {
+        close(fd);
+        for(const int wakeFd : wakeFds) {
+            if(wakeFd != -1) {
+                close(wakeFd);
+            }
+        }
+    }
+
+    /**
+     * Make reader look at answers and the stop flag.
+     */
+    void wake() const {
+        const char byte = 0;
+        const ssize_t written = write(wakeFds[1], &byte, 1);
+        (void)written;
+    }
+
+    const int fd;
+    int wakeFds[2];
+    std::mutex mutex;
+    unsigned long long requests = 0;
+    unsigned long long nextAnswer = 0;
+    std::map<unsigned long long, std::string> answers;
+    std::atomic<bool> finished{false};
+};
+
+Server::Server(const ServerOptions& options) : options(options), pool(options.numThreads) {
+    if(pipe(wakeFds) != 0) {
+        LOG_ERROR("Cannot create pipe: " << std::strerror(errno));
+        wakeFds[0] = wakeFds[1] = -1;
+    }
+}
+
+Server::~Server() {
+    stop();
+    if(listenFd != -1) {
+        close(listenFd);
+        unlink(path.c_str());
+    }
+    for(const int fd : wakeFds) {
+        if(fd != -1) {
+            close(fd);
+        }
+    }
+}
+
+bool Server::listen(const std::string& socketPath) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        LOG_ERROR("Invalid socket path " << socketPath);
+        return false;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+
+    // a socket left by a server that was killed, never a regular file
+    struct stat info;
+    if(lstat(socketPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+        unlink(socketPath.c_str());
+    }
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(fd == -1 || bind(fd, (const sockaddr*)&address, sizeof(address)) != 0
+            || ::listen(fd, SOMAXCONN) != 0) {
+        LOG_ERROR("Cannot listen on " << socketPath << ": " << std::strerror(errno));
+        if(fd != -1) {
+            close(fd);
+        }
+        return false;
+    }
+    listenFd = fd;
+    path = socketPath;
+    return true;
+}
+
+void Server::run() {
+    if(listenFd == -1) {
+        return;
+    }
+    while(!stopping) {
+        pollfd fds[2] = {{listenFd, POLLIN, 0}, {wakeFds[0], POLLIN, 0}};
+        if(poll(fds, wakeFds[0] == -1 ? 1 : 2, -1) < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Cannot wait for connections: " << std::strerror(errno));
+            break;
+        }
+        // woken by stop or by a reader that finished
+        if(fds[1].revents != 0) {
+            char bytes[64];
+            while(::read(wakeFds[0], bytes, sizeof(bytes)) == (ssize_t)sizeof(bytes)) {
+            }
+            reapReaders(false);
+            continue;
+        }
+        if((fds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+        const int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+        if(fd == -1) {
+            LOG_DEBUG("Cannot accept connection: " << std::strerror(errno));
+            continue;
+        }
+        reapReaders(false);
+        auto connection = std::make_shared<Connection>(fd);
+        if(connection->wakeFds[0] == -1) {
+            LOG_ERROR("Cannot create pipe: " << std::strerror(errno));
+            continue;
+        }
+        readers.push_back(Reader{connection, std::thread(&Server::serve, this, connection)});
+    }
+
+    stopping = true;
+    queueFreed.notify_all();
+    for(const auto& reader : readers) {
+        reader.connection->wake();
+    }
+    reapReaders(true);
+    pool.wait();
+    close(listenFd);
+    listenFd = -1;
+    unlink(path.c_str());
+}
+
+void Server::stop() {
+    stopping = true;
+    wakeRun();
+}
+
+void Server::wakeRun() {
+    if(wakeFds[1] != -1) {
+        const char byte = 0;
+        const ssize_t written = write(wakeFds[1], &byte, 1);
+        (void)written;
+    }
+}
+
+void Server::serve(const std::shared_ptr<Connection>& connection) {
+    LOG_DEBUG("Connection " << connection->fd << " opened");
+    std::string buffer, request, error, output;
+    std::vector<char> chunk(1 << 16);
+    size_t scanned = 0, written = 0;
+    bool reading = true, broken = false;
+    while(!broken) {
+        // answers next in order go to output
+        unsigned long long waiting;
+        {
+            std::lock_guard<std::mutex> lock(connection->mutex);
+            auto it = connection->answers.find(connection->nextAnswer);
+            while(it != connection->answers.end()) {
+                output += it->second;
+                connection->answers.erase(it);
+                it = connection->answers.find(++connection->nextAnswer);
+            }
+            waiting = connection->requests - connection->nextAnswer;
+        }
+        while(written < output.size()) {
+            const ssize_t n = send(connection->fd, output.data() + written, output.size() - written,
+                MSG_NOSIGNAL);
+            if(n < 0 && errno == EINTR) {
+                continue;
+            }
+            if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            if(n <= 0) {
+                LOG_DEBUG("Connection " << connection->fd << " lost");
+                broken = true;
+                break;
+            }
+            written += (size_t)n;
+        }
+        if(written == output.size()) {
+            output.clear();
+            written = 0;
+        }
+        // input left when stopping is dropped, complete requests are answered
+        if(stopping) {
+            reading = false;
+        }
+        if(broken || (!reading && waiting == 0 && output.empty())) {
+            break;
+        }
+
+        // a client not reading its answers is not read either
+        const short events = (reading && output.empty() && waiting < options.maxQueued ? POLLIN : 0)
+            | (output.empty() ? 0 : POLLOUT);
+        pollfd fds[2] = {{events != 0 ? connection->fd : -1, events, 0},
+            {connection->wakeFds[0], POLLIN, 0}};
+        const int ready = poll(fds, 2, stopping ? 1000 : -1);
+        if(ready < 0 && errno != EINTR) {
+            LOG_ERROR("Cannot wait for connection: " << std::strerror(errno));
+            break;
+        }
+        if(ready == 0 && !output.empty()) {
+            LOG_DEBUG("Connection " << connection->fd << " does not take answers, dropped");
+            break;
+        }
+        if(fds[1].revents != 0) {
+            char bytes[64];
+            while(::read(connection->wakeFds[0], bytes, sizeof(bytes)) == (ssize_t)sizeof(bytes)) {
+            }
+        }
+        if((fds[0].revents & (POLLIN | POLLHUP | POLLERR)) == 0 || !reading) {
+            continue;
+        }
+
+        const ssize_t n = ::read(connection->fd, chunk.data(), chunk.size());
+        if(n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) {
+            continue;
+        }
+        reading = n > 0;
+        if(reading) {
+            buffer.append(chunk.data(), (size_t)n);
+        }
+        size_t pos = 0;
+        Framing framing;
+        while((framing = nextRequest(buffer, pos, scanned, !reading, options.maxRequestBytes,
+                request, error)) == Framing::Complete) {
+            submit(connection, std::move(request));
+            request.clear();
+        }
+        buffer.erase(0, pos);
+        scanned -= pos;
+        if(framing == Framing::Malformed) {
+            LOG_DEBUG("Connection " << connection->fd << ": " << error);
+            std::lock_guard<std::mutex> lock(connection->mutex);
+            connection->answers.emplace(connection->requests++, "error " + error + "\n\n");
+            reading = false;
+        }
+    }
+
+    if(!broken) {
+        shutdown(connection->fd, SHUT_WR);
+    }
+    connection->finished = true;
+    wakeRun();
+    LOG_DEBUG("Connection " << connection->fd << " closed");
+}
+
+void Server::submit(const std::shared_ptr<Connection>& connection, std::string request) {
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        queueFreed.wait(lock, [this] { return queued < options.maxQueued || stopping; });
+        queued++;
+    }
+    unsigned long long sequence;
+    {
+        std::lock_guard<std::mutex> lock(connection->mutex);
+        sequence = connection->requests++;
+    }
+    auto text = std::make_shared<std::string>(std::move(request));
+    pool.submit([this, connection, sequence, text] {
+        answer(*connection, sequence, colorRequest(*text));
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queued--;
+        }
+        queueFreed.notify_one();
+    });
+}
+
+void Server::answer(Connection& connection, const unsigned long long sequence, std::string text) {
+    {
+        std::lock_guard<std::mutex> lock(connection.mutex);
+        connection.answers.emplace(sequence, std::move(text));
+    }
+    connection.wake();
+}
+
+void Server::reapReaders(const bool all) {
+    for(auto it = readers.begin(); it != readers.end();) {
+        if(all || it->connection->finished) {
+            it->thread.join();
+            it = readers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
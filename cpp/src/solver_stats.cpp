@@ -0,0 +1,66 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include "../include/solver_stats.h"
+
+#include <fstream>
+#include <sstream>
+
+void SolverStats::add(const SolverStats& other) {
+    vertices += other.vertices;
+    edges += other.edges;
+    success = success && other.success;
+    cyclesFound += other.cyclesFound;
+    pathsSplit += other.pathsSplit;
+    backtrackNodes += other.backtrackNodes;
+    backtrackUndone += other.backtrackUndone;
+    queuePushes += other.queuePushes;
+    queuePops += other.queuePops;
+    hangingEdgesPeeled += other.hangingEdgesPeeled;
+    forestIterations += other.forestIterations;
+    nogoodsLearned += other.nogoodsLearned;
+    totalTime += other.totalTime;
+    peelingTime += other.peelingTime;
+    cycleSearchTime += other.cycleSearchTime;
+    pathColoringTime += other.pathColoringTime;
+    forestColoringTime += other.forestColoringTime;
+}
+
+std::string SolverStats::toJson() const {
+    std::ostringstream os;
+    os << "{\n"
+       << "  \"vertices\": " << vertices << ",\n"
+       << "  \"edges\": " << edges << ",\n"
+       << "  \"success\": " << (success ? "true" : "false") << ",\n"
+       << "  \"counters\": {\n"
+       << "    \"cycles_found\": " << cyclesFound << ",\n"
+       << "    \"paths_split\": " << pathsSplit << ",\n"
+       << "    \"backtrack_nodes\": " << backtrackNodes << ",\n"
+       << "    \"backtrack_undone\": " << backtrackUndone << ",\n"
+       << "    \"queue_pushes\": " << queuePushes << ",\n"
+       << "    \"queue_pops\": " << queuePops << ",\n"
+       << "    \"hanging_edges_peeled\": " << hangingEdgesPeeled << ",\n"
+       << "    \"forest_iterations\": " << forestIterations << ",\n"
+       << "    \"nogoods_learned\": " << nogoodsLearned << "\n"
+       << "  },\n"
+       << "  \"phases_seconds\": {\n"
+       << "    \"total\": " << totalTime << ",\n"
+       << "    \"peeling\": " << peelingTime << ",\n"
+       << "    \"cycle_search\": " << cycleSearchTime << ",\n"
+       << "    \"path_coloring\": " << pathColoringTime << ",\n"
+       << "    \"forest_coloring\": " << forestColoringTime << "\n"
+       << "  }\n"
+       << "}\n";
+    return os.str();
+}
+
+bool SolverStats::writeJson(const std::string& fileName) const {
+    std::ofstream file(fileName);
+    if(!file) {
+        return false;
+    }
+    file << toJson();
+    return (bool)file;
+}
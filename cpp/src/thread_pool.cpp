@@ -0,0 +1,120 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include "../include/thread_pool.h"
+
+#include <algorithm>
+
+namespace {
+
+/**
+ * Pool and index of the worker running on this thread.
+ */
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local unsigned currentWorker = 0;
+
+}
+
+ThreadPool::ThreadPool(unsigned numThreads) {
+    if(numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for(unsigned i = 0; i < numThreads; i++) {
+        queues.emplace_back(new Queue());
+    }
+    for(unsigned i = 0; i < numThreads; i++) {
+        workers.emplace_back(&ThreadPool::run, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for(auto& w : workers) {
+        w.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    unsigned target;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        target = currentPool == this ? currentWorker : nextQueue++ % queues.size();
+        pending++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        queued++;
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(stateMutex);
+    idle.wait(lock, [this] { return pending == 0; });
+}
+
+bool ThreadPool::tryPop(const unsigned worker, std::function<void()>& task) {
+    {
+        // own tasks, newest first
+        Queue& own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for(size_t i = 1; i < queues.size(); i++) {
+        // steal oldest task of another worker
+        Queue& other = *queues[(worker + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if(!other.tasks.empty()) {
+            task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(const unsigned worker) {
+    currentPool = this;
+    currentWorker = worker;
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            wake.wait(lock, [this] { return stopping || queued > 0; });
+            if(stopping && queued == 0) {
+                return;
+            }
+        }
+        std::function<void()> task;
+        if(!tryPop(worker, task)) {
+            // another worker was faster
+            std::this_thread::yield();
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            queued--;
+        }
+        task();
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if(--pending == 0) {
+                idle.notify_all();
+            }
+        }
+    }
+}
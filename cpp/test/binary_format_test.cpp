@@ -0,0 +1,196 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../include/graph.h"
+#include "../include/binary_format.h"
+
+namespace {
+
+std::string readAll(const std::string& fileName) {
+    std::ifstream in(fileName, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+/**
+ * Adjacency with colors as text, for comparing graphs.
+ */
+std::string dump(const Graph& g) {
+    std::string out;
+    for(const auto& kv : g.getAdj()) {
+        out += std::to_string(kv.first) + ":";
+        for(const auto& e : kv.second) {
+            out += " " + std::to_string(e.v2) + "(" + std::to_string(e.color) + ")";
+        }
+        out += "\n";
+    }
+    return out;
+}
+
+/**
+ * Append section of integers padded to a multiple of 8 bytes.
+ */
+template<typename T>
+void appendSection(std::string& data, const std::vector<T>& values) {
+    data.append((const char*)values.data(), values.size() * sizeof(T));
+    data.append((8 - data.size() % 8) % 8, '\0');
+}
+
+/**
+ * Binary graph assembled from raw sections with uncolored edges, see BinaryGraphHeader.
+ */
+std::string binaryGraph(const std::vector<int32_t>& ids, const std::vector<uint64_t>& offsets,
+        const std::vector<int32_t>& neighbours, const std::vector<int32_t>& slotEdges,
+        const std::vector<int32_t>& ends, const uint32_t flags = BINARY_GRAPH_SORTED) {
+    const std::string valid = [] {
+        const std::string fileName = "gcolor_binary_header.gcb";
+        AdjList a;
+        a[1] = {Edge(1, 2)};
+        Graph(a).serializeBinary(fileName);
+        const std::string data = readAll(fileName);
+        std::remove(fileName.c_str());
+        return data;
+    }();
+    BinaryGraphHeader header;
+    std::memcpy(&header, valid.data(), sizeof(header));
+    header.numVertices = ids.size();
+    header.flags = flags;
+    header.numEdges = ends.size() / 2;
+    std::string data((const char*)&header, sizeof(header));
+    appendSection(data, ids);
+    appendSection(data, offsets);
+    appendSection(data, neighbours);
+    appendSection(data, slotEdges);
+    appendSection(data, ends);
+    appendSection(data, std::vector<int32_t>(ends.size() / 2, 0));
+    return data;
+}
+
+}
+
+TEST(Binary, RoundTripKeepsEdgesAndColors) {
+    const std::string fileName = "gcolor_binary_test.gcb";
+    AdjList a;
+    a[1] = {Edge(1, 2, 1), Edge(1, 3, 2)};
+    a[2] = {Edge(2, 1, 1), Edge(2, 3, 3)};
+    a[3] = {Edge(3, 1, 2), Edge(3, 2, 3), Edge(3, 100000000, 0)};
+    Graph g(a);
+    ASSERT_TRUE(g.serializeBinary(fileName));
+
+    Graph loaded(fileName);
+    std::remove(fileName.c_str());
+    EXPECT_EQ(dump(g), dump(loaded));
+    EXPECT_EQ(4, loaded.numEdges());
+    EXPECT_EQ(3, loaded.getEdge(3, 2).color);
+    EXPECT_EQ(1, loaded.getLowestColor(1));
+    EXPECT_EQ(2, loaded.getHighestColor(1));
+}
+
+TEST(Binary, RemovedEdgesAreNotWritten) {
+    const std::string fileName = "gcolor_binary_removed.gcb";
+    AdjList a;
+    a[1] = {Edge(1, 2), Edge(1, 3)};
+    a[2] = {Edge(2, 4)};
+    AdjList empty;
+    Graph g(a), other(empty);
+    g.moveEdgeToAnotherGraph(other, 2, 4);
+    ASSERT_TRUE(g.serializeBinary(fileName));
+
+    BinaryGraphView view(fileName);
+    ASSERT_TRUE(view.isValid());
+    EXPECT_EQ(3u, view.numVertices());
+    EXPECT_EQ(2u, view.numEdges());
+    std::remove(fileName.c_str());
+}
+
+TEST(Binary, CorruptedFileIsRejected) {
+    const std::string fileName = "gcolor_binary_corrupt.gcb";
+    AdjList a;
+    a[1] = {Edge(1, 2), Edge(1, 3)};
+    Graph g(a);
+    ASSERT_TRUE(g.serializeBinary(fileName));
+    std::string data = readAll(fileName);
+    std::remove(fileName.c_str());
+
+    EXPECT_TRUE(BinaryGraphView(data.data(), data.size()).isValid());
+    EXPECT_FALSE(BinaryGraphView(data.data(), data.size() - 4).isValid());
+    // point the first slot to a vertex that is not an endpoint of its edge
+    std::string broken = data;
+    const size_t neighboursAt = sizeof(BinaryGraphHeader) + 16 + 32;
+    broken[neighboursAt] = 0;
+    EXPECT_FALSE(BinaryGraphView(broken.data(), broken.size()).isValid());
+
+    // path 0 - 1 - 2 is consistent until ids or edges repeat
+    std::string path = binaryGraph({1, 2, 3}, {0, 1, 3, 4}, {1, 0, 2, 1}, {0, 0, 1, 1}, {0, 1, 1, 2});
+    EXPECT_TRUE(BinaryGraphView(path.data(), path.size()).isValid());
+    path = binaryGraph({1, 1, 1}, {0, 1, 3, 4}, {1, 0, 2, 1}, {0, 0, 1, 1}, {0, 1, 1, 2});
+    EXPECT_FALSE(BinaryGraphView(path.data(), path.size()).isValid());
+    const std::string twice = binaryGraph({1, 2}, {0, 2, 4}, {1, 1, 0, 0}, {0, 1, 0, 1}, {0, 1, 1, 0});
+    EXPECT_FALSE(BinaryGraphView(twice.data(), twice.size()).isValid());
+}
+
+TEST(Binary, SortedFlagIsChecked) {
+    // path 2 - 1 - 3 with vertex ids and edges out of order
+    const std::vector<int32_t> ids{2, 1, 3}, neighbours{1, 0, 2, 1}, slotEdges{1, 1, 0, 0};
+    const std::vector<uint64_t> offsets{0, 1, 3, 4};
+    const std::vector<int32_t> ends{1, 2, 0, 1};
+    const std::string unsorted = binaryGraph(ids, offsets, neighbours, slotEdges, ends, 0);
+    EXPECT_TRUE(BinaryGraphView(unsorted.data(), unsorted.size()).isValid());
+    const std::string flagged = binaryGraph(ids, offsets, neighbours, slotEdges, ends);
+    EXPECT_FALSE(BinaryGraphView(flagged.data(), flagged.size()).isValid());
+    const std::string unknown = binaryGraph(ids, offsets, neighbours, slotEdges, ends, 2);
+    EXPECT_FALSE(BinaryGraphView(unknown.data(), unknown.size()).isValid());
+}
+
+TEST(Binary, WrittenFileIsSortedLittleEndian) {
+    const std::string fileName = "gcolor_binary_sorted.gcb";
+    AdjList a;
+    a[9] = {Edge(9, 5), Edge(9, 7)};
+    a[5] = {Edge(5, 7)};
+    ASSERT_TRUE(Graph(a).serializeBinary(fileName));
+    const std::string data = readAll(fileName);
+    std::remove(fileName.c_str());
+
+    const unsigned char* header = (const unsigned char*)data.data();
+    EXPECT_EQ(std::vector<int>({1, 0, 0, 0}), std::vector<int>(header + 8, header + 12));
+    BinaryGraphView view(data.data(), data.size());
+    ASSERT_TRUE(view.isValid());
+    EXPECT_EQ(std::vector<int32_t>({5, 7, 9}),
+        std::vector<int32_t>(view.vertexIds(), view.vertexIds() + 3));
+}
+
+TEST(Binary, NegativeColorIsRejected) {
+    std::string path = binaryGraph({1, 2, 3}, {0, 1, 3, 4}, {1, 0, 2, 1}, {0, 0, 1, 1}, {0, 1, 1, 2});
+    ASSERT_TRUE(BinaryGraphView(path.data(), path.size()).isValid());
+    // colors are the last section, two edges
+    const int32_t negative = -1;
+    std::memcpy(&path[path.size() - 2 * sizeof(int32_t)], &negative, sizeof(negative));
+    EXPECT_FALSE(BinaryGraphView(path.data(), path.size()).isValid());
+}
+
+TEST(Binary, AdjacencyListConvertsToBinaryAndBack) {
+    const std::string textName = "gcolor_binary_text.adj", binaryName = "gcolor_binary_text.gcb";
+    {
+        std::ofstream out(textName);
+        out << "1 2 3\n2 3\n7\n";
+    }
+    Graph text(textName);
+    ASSERT_TRUE(text.serializeBinary(binaryName));
+    Graph binary(binaryName);
+    binary.serializeAdjacency(textName);
+    Graph again(textName);
+    std::remove(textName.c_str());
+    std::remove(binaryName.c_str());
+    EXPECT_EQ(dump(text), dump(binary));
+    EXPECT_EQ(dump(text), dump(again));
+    EXPECT_EQ(4u, binary.getAdj().size());
+}
@@ -0,0 +1,109 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include <gtest/gtest.h>
+#include <map>
+#include <set>
+
+#include "../include/block_decomposition.h"
+#include "../include/component_coloring.h"
+#include "../include/graph.h"
+
+namespace {
+
+void link(AdjList& a, const int v1, const int v2) {
+    a[v1].emplace_back(v1, v2);
+    a[v2].emplace_back(v2, v1);
+}
+
+/**
+ * Squares 0-1-2-3 and 4-5-6-7 joined by bridge 3-4, square 7-8-9-10
+ * sharing vertex 7 and a pendant edge 10-11.
+ */
+AdjList chainOfBlocks() {
+    AdjList a;
+    link(a, 0, 1); link(a, 1, 2); link(a, 2, 3); link(a, 3, 0);
+    link(a, 3, 4);
+    link(a, 4, 5); link(a, 5, 6); link(a, 6, 7); link(a, 7, 4);
+    link(a, 7, 8); link(a, 8, 9); link(a, 9, 10); link(a, 10, 7);
+    link(a, 10, 11);
+    return a;
+}
+
+}
+
+TEST(Blocks, EveryEdgeBelongsToOneBlock) {
+    CsrGraph g;
+    AdjList a = chainOfBlocks();
+    std::map<int, int> dense;
+    for(const auto& kv : a) {
+        dense[kv.first] = g.addVertex(kv.first);
+    }
+    for(const auto& kv : a) {
+        for(const auto& e : kv.second) {
+            if(e.v1 < e.v2) {
+                g.addEdge(dense[e.v1], dense[e.v2]);
+            }
+        }
+    }
+    BlockDecomposition blocks;
+    blocks.build(g);
+
+    ASSERT_EQ(5, blocks.numBlocks());
+    std::multiset<size_t> sizes;
+    std::set<int> edges;
+    for(int b = 0; b < blocks.numBlocks(); b++) {
+        sizes.insert(blocks.blockEnd(b) - blocks.blockBegin(b));
+        edges.insert(blocks.blockBegin(b), blocks.blockEnd(b));
+    }
+    EXPECT_EQ(std::multiset<size_t>({1, 1, 4, 4, 4}), sizes);
+    EXPECT_EQ(14u, edges.size());
+
+    std::set<int> cut;
+    for(int v = 0; v < g.vertexCapacity(); v++) {
+        if(blocks.isCutVertex(v)) {
+            cut.insert(g.idOf(v));
+        }
+    }
+    EXPECT_EQ(std::set<int>({3, 4, 7, 10}), cut);
+}
+
+TEST(Blocks, SplitBlocksSharesCutVertices) {
+    AdjList a = chainOfBlocks();
+    Graph g(a);
+    g.addVertexConstraint(7, 3);
+    auto blocks = g.splitBlocks();
+
+    ASSERT_EQ(5u, blocks.size());
+    int edges = 0, withSeven = 0;
+    for(auto& block : blocks) {
+        edges += block.numEdges();
+        if(block.getAdj().count(7)) {
+            withSeven++;
+            EXPECT_EQ(3, block.getHighestColor(7));
+        }
+    }
+    EXPECT_EQ(14, edges);
+    EXPECT_EQ(2, withSeven);
+    EXPECT_FALSE(g.isUncolored());
+}
+
+TEST(Blocks, ColoredBlocksAreJoinedAtCutVertices) {
+    AdjList a = chainOfBlocks();
+    // more blocks around cut vertex 7
+    link(a, 7, 12); link(a, 12, 13); link(a, 13, 14); link(a, 14, 7);
+    link(a, 7, 15);
+    Graph g(a);
+    AdjList empty;
+    Graph outGraph(empty);
+
+    EXPECT_TRUE(g.isUncolored());
+    EXPECT_TRUE(colorComponents(g, outGraph, 2));
+    EXPECT_EQ(19, outGraph.numEdges());
+    for(const auto& kv : outGraph.getAdj()) {
+        EXPECT_TRUE(outGraph.isOK(kv.first)) << "vertex " << kv.first;
+        EXPECT_GE(outGraph.getLowestColor(kv.first), 1);
+    }
+}
@@ -0,0 +1,56 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+
+#include "../include/color_set.h"
+
+TEST(ColorSet, WindowMovesDownToLowestColor) {
+    ColorSet colors;
+    EXPECT_EQ(-1, colors.lowest());
+    EXPECT_EQ(-1, colors.highest());
+    EXPECT_TRUE(colors.insert(70));
+    EXPECT_TRUE(colors.insert(5));
+    EXPECT_FALSE(colors.insert(70));
+    EXPECT_TRUE(colors.insert(6));
+
+    EXPECT_EQ(3, colors.size());
+    EXPECT_EQ(5, colors.lowest());
+    EXPECT_EQ(70, colors.highest());
+    EXPECT_TRUE(colors.contains(6));
+    EXPECT_FALSE(colors.contains(7));
+    EXPECT_EQ(7, colors.firstGap());
+    EXPECT_EQ(70, colors.next(7));
+    EXPECT_EQ(std::vector<int>({5, 6, 70}), colors.toVector());
+}
+
+TEST(ColorSet, ConsecutiveColorsHaveNoGaps) {
+    ColorSet colors;
+    for(int c = 100; c > 0; c--) {
+        colors.insert(c);
+    }
+    EXPECT_FALSE(colors.hasGaps());
+    EXPECT_EQ(-1, colors.firstGap());
+    EXPECT_EQ(1, colors.lowest());
+    EXPECT_EQ(100, colors.highest());
+}
+
+TEST(ColorSet, WideSpanMatchesStdSet) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pick(1, 400);
+    ColorSet colors;
+    std::set<int> expected;
+    for(int i = 0; i < 100; i++) {
+        const int c = pick(rng);
+        EXPECT_EQ(expected.insert(c).second, colors.insert(c));
+        ASSERT_EQ(std::vector<int>(expected.begin(), expected.end()), colors.toVector());
+        EXPECT_EQ(*expected.begin(), colors.lowest());
+        EXPECT_EQ(*expected.rbegin(), colors.highest());
+        const auto after = expected.lower_bound(200);
+        EXPECT_EQ(after == expected.end() ? -1 : *after, colors.next(200));
+    }
+}
@@ -0,0 +1,123 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+
+#include "../include/component_coloring.h"
+#include "../include/thread_pool.h"
+
+namespace {
+
+void link(AdjList& a, const int v1, const int v2) {
+    a[v1].emplace_back(v1, v2);
+    a[v2].emplace_back(v2, v1);
+}
+
+/**
+ * Cycles of given lengths, each on its own vertices starting at multiples of 100.
+ */
+AdjList disjointCycles(const std::vector<int>& lengths) {
+    AdjList a;
+    for(size_t c = 0; c < lengths.size(); c++) {
+        const int base = 100 * (int)c;
+        for(int i = 0; i < lengths[c]; i++) {
+            link(a, base + i, base + (i + 1) % lengths[c]);
+        }
+    }
+    return a;
+}
+
+}
+
+TEST(ThreadPool, RunsAllTasksIncludingNestedOnes) {
+    std::atomic<int> done(0);
+    {
+        ThreadPool pool(3);
+        for(int i = 0; i < 50; i++) {
+            pool.submit([&] {
+                pool.submit([&] { done++; });
+                done++;
+            });
+        }
+        pool.wait();
+        EXPECT_EQ(100, done.load());
+    }
+}
+
+TEST(Components, SplitKeepsEdgesColorsAndConstraints) {
+    AdjList a = disjointCycles({3, 4, 5});
+    link(a, 500, 501);
+    a[7];
+    Graph g(a);
+    g.colorEdge(100, 101, 2);
+    g.addVertexConstraint(200, 4);
+
+    auto components = g.splitComponents();
+    ASSERT_EQ(4u, components.size());
+    EXPECT_EQ(3, components[0].numEdges());
+    EXPECT_EQ(4, components[1].numEdges());
+    EXPECT_EQ(5, components[2].numEdges());
+    EXPECT_EQ(1, components[3].numEdges());
+    EXPECT_EQ(2, components[1].getEdge(101, 100).color);
+    EXPECT_EQ(4, components[2].getHighestColor(200));
+    EXPECT_TRUE(components[0].isEdge(2, 0));
+    EXPECT_FALSE(components[0].isEdge(100, 101));
+}
+
+TEST(Components, ColoringComponentsInParallelColorsWholeGraph) {
+    AdjList a = disjointCycles({4, 6, 8, 10, 12});
+    for(int v = 0; v < 4; v++) {
+        link(a, 1000 + v, 1001 + v);
+    }
+    Graph g(a);
+    AdjList empty;
+    Graph outGraph(empty);
+    SolverStats stats;
+
+    EXPECT_TRUE(colorComponents(g, outGraph, 4, &stats));
+    EXPECT_TRUE(g.isEmpty());
+    EXPECT_EQ(44, outGraph.numEdges());
+    for(const auto& kv : outGraph.getAdj()) {
+        EXPECT_TRUE(outGraph.isOK(kv.first)) << "vertex " << kv.first;
+    }
+    EXPECT_TRUE(stats.success);
+    EXPECT_EQ(44, stats.edges);
+}
+
+TEST(Components, FailingComponentFailsWholeGraph) {
+    AdjList a = disjointCycles({4});
+    for(int v1 = 0; v1 < 6; v1++) {
+        for(int v2 = v1 + 1; v2 < 6; v2++) {
+            link(a, 100 + v1, 100 + v2);
+        }
+    }
+    Graph g(a);
+    AdjList empty;
+    Graph outGraph(empty);
+
+    EXPECT_FALSE(colorComponents(g, outGraph, 2));
+}
+
+TEST(Components, CancelledBlocksAreReturnedUncolored) {
+    // two 4-cycles sharing vertex 0 form one component of two blocks
+    AdjList a;
+    for(const int base : {0, 10}) {
+        link(a, 0, base + 1);
+        link(a, base + 1, base + 2);
+        link(a, base + 2, base + 3);
+        link(a, base + 3, 0);
+    }
+    Graph g(a);
+    AdjList empty;
+    Graph outGraph(empty);
+    const std::atomic<bool> cancelled(true);
+    SolverConfig config;
+    config.cancelled = &cancelled;
+
+    EXPECT_FALSE(colorComponents(g, outGraph, 1, nullptr, &config));
+    EXPECT_EQ(8, g.numEdges() + outGraph.numEdges());
+    EXPECT_EQ(0, outGraph.numEdges());
+}
@@ -0,0 +1,109 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include <gtest/gtest.h>
+
+#include "../include/csr_graph.h"
+
+TEST(Csr, BuildingFromRowsKeepsOneRecordPerEdge) {
+    CsrGraph g;
+    const std::vector<int> rowIds{1, 2, 3};
+    const std::vector<size_t> rowOffsets{0, 2, 4, 6};
+    const std::vector<int> neighbourIds{2, 3, 1, 3, 1, 2};
+    g.build(rowIds, rowOffsets, neighbourIds);
+    EXPECT_EQ(3, g.numVertices());
+    EXPECT_EQ(3, g.numEdges());
+    const int v1 = g.indexOf(1), v2 = g.indexOf(2);
+    const int e = g.findEdge(v1, v2);
+    EXPECT_NE(-1, e);
+    EXPECT_EQ(e, g.findEdge(v2, v1));
+    EXPECT_EQ(2, g.idOf(g.neighbour(v1, 0)));
+    EXPECT_EQ(3, g.idOf(g.neighbour(v1, 1)));
+}
+
+TEST(Csr, EdgeListedByOneEndpointIsAddedToBoth) {
+    CsrGraph g;
+    g.build(std::vector<int>{1}, std::vector<size_t>{0, 1}, std::vector<int>{7});
+    EXPECT_EQ(1, g.degree(g.indexOf(7)));
+    EXPECT_EQ(1, g.idOf(g.neighbour(g.indexOf(7), 0)));
+}
+
+TEST(Csr, RemovingEdgeUpdatesIndexAndPresence) {
+    CsrGraph g;
+    const int a = g.addVertex(5), b = g.addVertex(6), c = g.addVertex(7);
+    const int e1 = g.addEdge(a, b, 3);
+    g.addEdge(a, c, 4);
+    EXPECT_EQ(e1, g.addEdge(b, a));
+    EXPECT_EQ(3, g.edge(e1).color);
+    g.removeEdge(e1);
+    EXPECT_EQ(-1, g.findEdge(a, b));
+    EXPECT_FALSE(g.isEdge(e1));
+    EXPECT_FALSE(g.isPresent(b));
+    EXPECT_TRUE(g.isPresent(a));
+    EXPECT_EQ(1, g.degree(a));
+    EXPECT_EQ(7, g.idOf(g.neighbour(a, 0)));
+    EXPECT_EQ(2, g.numVertices());
+}
+
+TEST(Csr, ParkedEdgeKeepsIdAndColorUntilRestored) {
+    CsrGraph g;
+    const int a = g.addVertex(5), b = g.addVertex(6), c = g.addVertex(7);
+    const int e1 = g.addEdge(a, b, 3);
+    const int e2 = g.addEdge(a, c);
+    g.parkEdge(e1);
+    EXPECT_TRUE(g.isParked(e1));
+    EXPECT_FALSE(g.isEdge(e1));
+    EXPECT_EQ(-1, g.findEdge(a, b));
+    EXPECT_EQ(1, g.degree(a));
+    EXPECT_EQ(e2, g.edgeAt(a, 0));
+    EXPECT_FALSE(g.isPresent(b));
+    EXPECT_EQ(1, g.numEdges());
+
+    g.restoreEdge(e1);
+    EXPECT_TRUE(g.isEdge(e1));
+    EXPECT_EQ(e1, g.findEdge(b, a));
+    EXPECT_EQ(3, g.edge(e1).color);
+    EXPECT_EQ(2, g.degree(a));
+    EXPECT_TRUE(g.isPresent(b));
+    EXPECT_EQ(2, g.numEdges());
+}
+
+TEST(Csr, GrowingBlocksKeepsAdjacencyConsistent) {
+    CsrGraph g;
+    const int n = 200;
+    for(int i = 0; i < n; i++) {
+        g.addVertex(i);
+    }
+    for(int i = 0; i < n; i++) {
+        for(int j = i + 1; j < n; j += 7) {
+            g.addEdge(g.indexOf(i), g.indexOf(j), i + j);
+        }
+    }
+    for(int i = 0; i < n; i += 3) {
+        const int e = g.findEdge(g.indexOf(i), g.indexOf((i + 7) % n));
+        if(e != -1) {
+            g.removeEdge(e);
+        }
+    }
+    int slots = 0;
+    for(int v = 0; v < g.vertexCapacity(); v++) {
+        for(int i = 0; i < g.degree(v); i++) {
+            const int e = g.edgeAt(v, i);
+            EXPECT_EQ(g.neighbour(v, i), g.other(e, v));
+            EXPECT_EQ(e, g.findEdge(v, g.neighbour(v, i)));
+            slots++;
+        }
+    }
+    EXPECT_EQ(2 * g.numEdges(), slots);
+}
+
+TEST(Csr, LargeAndNegativeIdsAreSupported) {
+    CsrGraph g;
+    const int a = g.addVertex(-5), b = g.addVertex(1 << 30);
+    g.addEdge(a, b);
+    EXPECT_EQ(a, g.indexOf(-5));
+    EXPECT_EQ(b, g.indexOf(1 << 30));
+    EXPECT_EQ(-1, g.indexOf(12));
+}
@@ -0,0 +1,150 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <set>
+
+#include "../include/cycle_decomposition.h"
+#include "../include/graph.h"
+
+namespace {
+
+CsrGraph randomGraph(const int n, const int m, const unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    CsrGraph g;
+    for(int v = 0; v < n; v++) {
+        g.addVertex(v);
+    }
+    for(int i = 0; i < m; i++) {
+        const int a = pick(rng), b = pick(rng);
+        if(a != b) {
+            g.addEdge(a, b);
+        }
+    }
+    return g;
+}
+
+int findRoot(std::vector<int>& parent, int v) {
+    while(parent[v] != v) {
+        v = parent[v] = parent[parent[v]];
+    }
+    return v;
+}
+
+}
+
+TEST(Cycles, CyclesAreEdgeDisjointAndLeaveForest) {
+    for(unsigned seed = 1; seed <= 20; seed++) {
+        const CsrGraph g = randomGraph(60, 120, seed);
+        CycleDecomposition cycles;
+        cycles.build(g, 0);
+
+        std::set<int> usedEdges;
+        std::vector<int> cycle;
+        while(cycles.next(g, cycle)) {
+            ASSERT_GE(cycle.size(), 4u);
+            ASSERT_EQ(cycle.front(), cycle.back());
+            for(size_t i = 0; i + 1 < cycle.size(); i++) {
+                const int e = g.findEdge(cycle[i], cycle[i+1]);
+                ASSERT_NE(-1, e);
+                EXPECT_TRUE(usedEdges.insert(e).second) << "edge used twice, seed " << seed;
+            }
+        }
+
+        // remaining edges must not close a cycle
+        std::vector<int> parent(g.vertexCapacity());
+        std::iota(parent.begin(), parent.end(), 0);
+        for(int e = 0; e < g.edgeCapacity(); e++) {
+            if(!g.isEdge(e) || usedEdges.count(e)) {
+                continue;
+            }
+            const int a = findRoot(parent, g.endpoints(e).first);
+            const int b = findRoot(parent, g.endpoints(e).second);
+            EXPECT_NE(a, b) << "cycle left in remaining edges, seed " << seed;
+            parent[a] = b;
+        }
+    }
+}
+
+TEST(Cycles, CycleWithRemovedEdgeIsSkipped) {
+    CsrGraph g;
+    // two triangles sharing vertex 0
+    for(int v = 0; v < 5; v++) {
+        g.addVertex(v);
+    }
+    g.addEdge(0, 1);
+    g.addEdge(1, 2);
+    g.addEdge(2, 0);
+    g.addEdge(0, 3);
+    g.addEdge(3, 4);
+    g.addEdge(4, 0);
+    CycleDecomposition cycles;
+    cycles.build(g, 0);
+    EXPECT_EQ(2, cycles.numCycles());
+
+    g.removeEdge(g.findEdge(1, 2));
+    std::vector<int> cycle;
+    ASSERT_TRUE(cycles.next(g, cycle));
+    const std::vector<int> expected{0, 3, 4, 0};
+    EXPECT_EQ(expected, cycle);
+    EXPECT_FALSE(cycles.next(g, cycle));
+}
+
+TEST(Cycles, GraphRebuildsDecompositionAfterEdgesAreAdded) {
+    AdjList a;
+    a[1] = {Edge(1, 2), Edge(1, 3)};
+    a[2] = {Edge(2, 3)};
+    Graph g(a);
+    AdjList empty;
+    Graph out(empty);
+
+    const auto first = g.nextCycle();
+    ASSERT_EQ(4u, first.size());
+    EXPECT_EQ(1, first.front());
+    for(const auto& edge : g.pathEdges(first)) {
+        g.moveEdgeToAnotherGraph(out, edge);
+    }
+    EXPECT_TRUE(g.nextCycle().empty());
+
+    out.moveAllEdgesToAnotherGraph(g);
+    EXPECT_EQ(4u, g.nextCycle().size());
+}
+
+TEST(Cycles, PrioritizedCyclesComeMostConstrainedFirst) {
+    CsrGraph g;
+    // three triangles sharing vertex 0
+    for(int v = 0; v < 7; v++) {
+        g.addVertex(v);
+    }
+    for(int t = 0; t < 3; t++) {
+        g.addEdge(0, 2 * t + 1);
+        g.addEdge(2 * t + 1, 2 * t + 2);
+        g.addEdge(2 * t + 2, 0);
+    }
+    CycleDecomposition cycles;
+    cycles.build(g, 0);
+    ASSERT_EQ(3, cycles.numCycles());
+
+    std::vector<long long> scores(7, 0);
+    scores[3] = 10;
+    const auto score = [&scores](const int v) { return scores[v]; };
+    cycles.prioritize(score);
+    std::vector<int> cycle;
+    ASSERT_TRUE(cycles.next(g, cycle));
+    EXPECT_NE(cycle.end(), std::find(cycle.begin(), cycle.end(), 3));
+
+    // vertex 6 got tighter, its cycle is requeued ahead of the remaining one
+    scores[6] = 20;
+    cycles.reprioritize({6}, score);
+    ASSERT_TRUE(cycles.next(g, cycle));
+    EXPECT_NE(cycle.end(), std::find(cycle.begin(), cycle.end(), 6));
+    ASSERT_TRUE(cycles.next(g, cycle));
+    EXPECT_NE(cycle.end(), std::find(cycle.begin(), cycle.end(), 1));
+    EXPECT_FALSE(cycles.next(g, cycle));
+}
@@ -0,0 +1,136 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+
+#include "../include/exact_solver.h"
+
+namespace {
+
+void link(AdjList& a, const int v1, const int v2) {
+    a[v1].emplace_back(v1, v2);
+    a[v2].emplace_back(v2, v1);
+}
+
+AdjList complete(const int n) {
+    AdjList a;
+    for(int i = 0; i < n; i++) {
+        for(int j = i + 1; j < n; j++) {
+            link(a, i, j);
+        }
+    }
+    return a;
+}
+
+AdjList cycle(const int n, const int first = 0) {
+    AdjList a;
+    for(int i = 0; i < n; i++) {
+        link(a, first + i, first + (i + 1) % n);
+    }
+    return a;
+}
+
+void expectValid(Graph& outGraph, const int numEdges) {
+    EXPECT_EQ(numEdges, outGraph.numEdges());
+    int lowest = 1 << 30;
+    for(const auto& kv : outGraph.getAdj()) {
+        EXPECT_TRUE(outGraph.isOK(kv.first)) << "vertex " << kv.first;
+        for(const auto& e : kv.second) {
+            lowest = std::min(lowest, e.color);
+        }
+    }
+    EXPECT_EQ(1, lowest);
+}
+
+}
+
+TEST(ExactSolver, ColorsEvenCompleteGraphs) {
+    for(const int n : {2, 4, 6, 8}) {
+        AdjList a = complete(n);
+        Graph g(a);
+        AdjList empty;
+        Graph outGraph(empty);
+        SolverStats stats;
+        EXPECT_EQ(ExactResult::Colored, colorExact(g, outGraph, ExactLimits(), &stats)) << "K" << n;
+        expectValid(outGraph, n * (n - 1) / 2);
+        EXPECT_TRUE(g.isEmpty());
+        EXPECT_TRUE(stats.success);
+        EXPECT_GT(stats.backtrackNodes, 0);
+    }
+}
+
+TEST(ExactSolver, ProvesOddCyclesAndCompleteGraphsInfeasible) {
+    for(const int n : {3, 5, 7}) {
+        AdjList a = cycle(n);
+        Graph g(a);
+        AdjList empty;
+        Graph outGraph(empty);
+        EXPECT_EQ(ExactResult::Infeasible, colorExact(g, outGraph)) << "C" << n;
+        EXPECT_EQ(n, g.numEdges());
+        EXPECT_EQ(0, outGraph.numEdges());
+    }
+    AdjList a = complete(5);
+    Graph g(a);
+    AdjList empty;
+    Graph outGraph(empty);
+    SolverStats stats;
+    EXPECT_EQ(ExactResult::Infeasible, colorExact(g, outGraph, ExactLimits(), &stats));
+    EXPECT_FALSE(stats.success);
+}
+
+TEST(ExactSolver, DecidesDenseGraphsOnSevenVerticesQuickly) {
+    ExactLimits limits;
+    limits.maxSeconds = 1;
+    AdjList a = complete(7);
+    Graph g(a);
+    AdjList empty;
+    Graph outGraph(empty);
+    EXPECT_EQ(ExactResult::Infeasible, colorExact(g, outGraph, limits));
+    EXPECT_EQ(21, g.numEdges());
+
+    // not regular, so it is refuted by search
+    for(const auto& missing : {std::make_pair(0, 1), std::make_pair(2, 3), std::make_pair(4, 5)}) {
+        auto& row = a[missing.first];
+        row.erase(std::find_if(row.begin(), row.end(), [&](const Edge& e) { return e.v2 == missing.second; }));
+        auto& other = a[missing.second];
+        other.erase(std::find_if(other.begin(), other.end(), [&](const Edge& e) { return e.v2 == missing.first; }));
+    }
+    Graph sparser(a);
+    SolverStats stats;
+    EXPECT_EQ(ExactResult::Infeasible, colorExact(sparser, outGraph, limits, &stats));
+    EXPECT_EQ(18, sparser.numEdges());
+    EXPECT_GT(stats.backtrackNodes, 0);
+}
+
+TEST(ExactSolver, KeepsInfeasibleComponentsInGraph) {
+    AdjList a = cycle(4);
+    for(const auto& kv : cycle(3, 10)) {
+        a[kv.first] = kv.second;
+    }
+    Graph g(a);
+    AdjList empty;
+    Graph outGraph(empty);
+    EXPECT_EQ(ExactResult::Infeasible, colorExact(g, outGraph));
+    expectValid(outGraph, 4);
+    EXPECT_EQ(3, g.numEdges());
+}
+
+TEST(ExactSolver, StopsAtLimits) {
+    AdjList a = complete(6);
+    Graph g(a);
+    AdjList empty;
+    Graph outGraph(empty);
+    ExactLimits limits;
+    limits.maxNodes = 2;
+    EXPECT_EQ(ExactResult::LimitReached, colorExact(g, outGraph, limits));
+    EXPECT_EQ(15, g.numEdges());
+    EXPECT_EQ(0, outGraph.numEdges());
+
+    limits = ExactLimits();
+    limits.maxEdges = 14;
+    EXPECT_EQ(ExactResult::LimitReached, colorExact(g, outGraph, limits));
+    EXPECT_EQ(15, g.numEdges());
+}
@@ -0,0 +1,108 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include <gtest/gtest.h>
+
+#include "../include/gcolor.h"
+#include "../include/log.h"
+
+#include <map>
+#include <set>
+
+namespace {
+
+/**
+ * Check that colors of edges at every vertex are distinct and consecutive.
+ */
+void expectInterval(const std::vector<std::pair<int, int> >& edges, const std::vector<int>& colors) {
+    ASSERT_EQ(edges.size(), colors.size());
+    std::map<std::pair<int, int>, int> unique;
+    for(size_t i = 0; i < edges.size(); i++) {
+        EXPECT_GT(colors[i], 0) << "edge " << i;
+        const auto key = std::make_pair(std::min(edges[i].first, edges[i].second),
+            std::max(edges[i].first, edges[i].second));
+        const auto it = unique.emplace(key, colors[i]).first;
+        EXPECT_EQ(it->second, colors[i]) << "edge " << i;
+    }
+    std::map<int, std::set<int> > atVertex;
+    std::map<int, int> degree;
+    for(const auto& kv : unique) {
+        for(const int v : {kv.first.first, kv.first.second}) {
+            atVertex[v].insert(kv.second);
+            degree[v]++;
+        }
+    }
+    for(const auto& kv : atVertex) {
+        EXPECT_EQ(degree[kv.first], (int)kv.second.size()) << "vertex " << kv.first;
+        EXPECT_EQ(degree[kv.first] - 1, *kv.second.rbegin() - *kv.second.begin())
+            << "vertex " << kv.first;
+    }
+}
+
+}
+
+TEST(Library, ColorsEdgeArrayInInputOrder) {
+    // even cycle with sparse and negative ids, one edge repeated backwards
+    const int ends[] = {-5, 7, 7, 1000000, 1000000, 3, 3, -5, 1000000, 7};
+    int colors[5] = {0};
+    SolverStats stats;
+    EXPECT_EQ(ColoringStatus::Colored, colorEdges(ends, 5, colors, ColoringOptions(), &stats));
+    expectInterval({{-5, 7}, {7, 1000000}, {1000000, 3}, {3, -5}, {1000000, 7}},
+        std::vector<int>(colors, colors + 5));
+    EXPECT_EQ(4, stats.edges);
+    EXPECT_TRUE(stats.success);
+}
+
+TEST(Library, ReportsStatusOfEverySolver) {
+    const std::vector<std::pair<int, int> > triangle = {{0, 1}, {1, 2}, {2, 0}};
+    ColoringResult result = colorEdges(triangle);
+    EXPECT_EQ(ColoringStatus::Failed, result.status);
+    EXPECT_EQ(3u, result.colors.size());
+    EXPECT_FALSE(result.stats.success);
+
+    ColoringOptions options;
+    options.exact = true;
+    EXPECT_EQ(ColoringStatus::Infeasible, colorEdges(triangle, options).status);
+    options.exactLimits.maxEdges = 2;
+    EXPECT_EQ(ColoringStatus::LimitReached, colorEdges(triangle, options).status);
+
+    const std::vector<std::pair<int, int> > cycle = {{0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 5}, {5, 0}};
+    options = ColoringOptions();
+    options.numInstances = 3;
+    result = colorEdges(cycle, options);
+    EXPECT_EQ(ColoringStatus::Colored, result.status);
+    expectInterval(cycle, result.colors);
+}
+
+TEST(Library, RejectsInvalidInputAndHonoursCancellation) {
+    EXPECT_EQ(ColoringStatus::InvalidInput, colorEdges({{1, 2}, {2, 2}}).status);
+    EXPECT_EQ(ColoringStatus::InvalidInput, colorEdges(nullptr, 1, nullptr));
+    EXPECT_EQ(ColoringStatus::Colored, colorEdges(nullptr, 0, nullptr));
+
+    const std::atomic<bool> cancelled(true);
+    ColoringOptions options;
+    options.cancelled = &cancelled;
+    const std::vector<std::pair<int, int> > square = {{0, 1}, {1, 2}, {2, 3}, {3, 0}};
+    const ColoringResult result = colorEdges(square, options);
+    EXPECT_EQ(ColoringStatus::Failed, result.status);
+    EXPECT_EQ(std::vector<int>(4, 0), result.colors);
+
+    options.numInstances = 3;
+    EXPECT_EQ(ColoringStatus::Failed, colorEdges(square, options).status);
+    options.exact = true;
+    EXPECT_EQ(ColoringStatus::LimitReached, colorEdges(square, options).status);
+}
+
+TEST(Library, PrintsNothingByDefault) {
+    const LogLevel previous = logLevel;
+    logLevel = LogLevel::Debug;
+    testing::internal::CaptureStderr();
+    testing::internal::CaptureStdout();
+    colorEdges({{0, 1}, {1, 2}, {2, 0}});
+    flushLog();
+    logLevel = previous;
+    EXPECT_EQ("", testing::internal::GetCapturedStdout());
+    EXPECT_EQ("", testing::internal::GetCapturedStderr());
+}
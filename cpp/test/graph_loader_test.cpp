@@ -0,0 +1,74 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "../include/graph.h"
+#include "../include/graph_loader.h"
+
+namespace {
+
+AdjacencyRows parse(const std::string& text, const unsigned threads) {
+    AdjacencyRows rows;
+    parseAdjacencyRows(text.data(), text.data() + text.size(), rows, threads);
+    return rows;
+}
+
+}
+
+TEST(Loader, ParsingRowsWorks) {
+    const auto rows = parse("1 7 9\n2 8\n\n  3\t6 -8 \r\n4", 1);
+    const std::vector<int> expectedIds{1, 2, 3, 4};
+    const std::vector<size_t> expectedOffsets{0, 2, 3, 5, 5};
+    const std::vector<int> expectedNeighbours{7, 9, 8, 6, -8};
+    EXPECT_EQ(expectedIds, rows.rowIds);
+    EXPECT_EQ(expectedOffsets, rows.rowOffsets);
+    EXPECT_EQ(expectedNeighbours, rows.neighbourIds);
+}
+
+TEST(Loader, LineEndsAtFirstNonIntegerToken) {
+    const auto rows = parse("1 2 x 3\n5 6\n", 1);
+    const std::vector<int> expectedNeighbours{2, 6};
+    EXPECT_EQ(expectedNeighbours, rows.neighbourIds);
+}
+
+TEST(Loader, ParsingInChunksGivesSameRowsAsSingleThread) {
+    std::string text;
+    for(int v = 0; v < 500; v++) {
+        text += std::to_string(v);
+        for(int n = 1; n <= v % 7; n++) {
+            text += " " + std::to_string((v * 31 + n) % 500);
+        }
+        text += "\n";
+    }
+    const auto single = parse(text, 1);
+    for(unsigned threads = 2; threads <= 9; threads++) {
+        const auto chunked = parse(text, threads);
+        EXPECT_EQ(single.rowIds, chunked.rowIds) << "threads: " << threads;
+        EXPECT_EQ(single.rowOffsets, chunked.rowOffsets) << "threads: " << threads;
+        EXPECT_EQ(single.neighbourIds, chunked.neighbourIds) << "threads: " << threads;
+    }
+}
+
+TEST(Loader, LoadingGraphFromFileWorks) {
+    const std::string fileName = "gcolor_loader_test.txt";
+    {
+        std::ofstream out(fileName);
+        out << "1 2 3\n2 1 3\n3 1 2\n";
+    }
+    Graph g(fileName);
+    std::remove(fileName.c_str());
+    EXPECT_EQ(3, g.numEdges());
+    EXPECT_EQ(3, g.getAdj().size());
+    EXPECT_TRUE(g.isEdge(1, 3));
+}
+
+TEST(Loader, LoadingMissingFileFails) {
+    AdjacencyRows rows;
+    EXPECT_FALSE(loadAdjacencyRows("no/such/file", rows));
+}
@@ -0,0 +1,38 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include <gtest/gtest.h>
+
+#include "../include/graph_pool.h"
+
+TEST(Pool, ReleasedGraphIsReusedEmpty) {
+    GraphPool pool;
+    SolverStats stats;
+    Graph& first = pool.acquire(&stats);
+    first.addEdge(Edge(1, 2, 3));
+    first.addVertexConstraint(1, 5);
+    pool.release(first);
+
+    Graph& second = pool.acquire(nullptr);
+    EXPECT_EQ(&first, &second);
+    EXPECT_EQ(1u, pool.size());
+    EXPECT_TRUE(second.isEmpty());
+    EXPECT_EQ(-1, second.getHighestColor(1));
+    EXPECT_TRUE(second.getAdj().empty());
+
+    second.addEdge(Edge(3, 4));
+    EXPECT_EQ(1, second.numEdges());
+    EXPECT_TRUE(second.isEdge(4, 3));
+}
+
+TEST(Pool, AcquiredGraphsAreDistinct) {
+    GraphPool pool;
+    Graph& a = pool.acquire(nullptr);
+    Graph& b = pool.acquire(nullptr);
+    a.addEdge(Edge(1, 2));
+    EXPECT_NE(&a, &b);
+    EXPECT_TRUE(b.isEmpty());
+    EXPECT_EQ(2u, pool.size());
+}
@@ -0,0 +1,103 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../include/log.h"
+
+namespace {
+
+/**
+ * Redirects the log to a temporary file and restores level and sink afterwards.
+ */
+class CapturedLog {
+public:
+    explicit CapturedLog(const LogLevel level) : previous(logLevel), file(std::tmpfile()) {
+        logLevel = level;
+        setLogSink(file);
+    }
+    ~CapturedLog() {
+        setLogSink(nullptr);
+        logLevel = previous;
+        std::fclose(file);
+    }
+    std::FILE* sink() const { return file; }
+    std::string text() {
+        flushLog();
+        std::string result;
+        std::rewind(file);
+        char chunk[256];
+        size_t n;
+        while((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            result.append(chunk, n);
+        }
+        return result;
+    }
+private:
+    const LogLevel previous;
+    std::FILE* file;
+};
+
+int evaluations = 0;
+
+int counted() {
+    return ++evaluations;
+}
+
+}
+
+TEST(Log, ParsingLevelsWorks) {
+    LogLevel level = LogLevel::Info;
+    EXPECT_TRUE(parseLogLevel("trace", level));
+    EXPECT_EQ(LogLevel::Trace, level);
+    EXPECT_TRUE(parseLogLevel("error", level));
+    EXPECT_EQ(LogLevel::Error, level);
+    EXPECT_FALSE(parseLogLevel("loud", level));
+    EXPECT_EQ(LogLevel::Error, level);
+}
+
+TEST(Log, MessagesAboveLevelAreNotEvaluated) {
+    CapturedLog log(LogLevel::Info);
+    evaluations = 0;
+    LOG_INFO("info " << counted());
+    LOG_DEBUG("debug " << counted());
+    LOG_TRACE("trace " << counted());
+    EXPECT_EQ(1, evaluations);
+    EXPECT_EQ("info 1\n", log.text());
+}
+
+TEST(Log, TraceFollowsCompileTimeFloor) {
+    CapturedLog log(LogLevel::Trace);
+    evaluations = 0;
+    LOG_TRACE("trace " << counted());
+    EXPECT_EQ(GCOLOR_LOG_FLOOR >= 3 ? 1 : 0, evaluations);
+}
+
+TEST(Log, VerboseLevelIsCompiledIn) {
+    CapturedLog log(VERBOSE_LOG_LEVEL);
+    EXPECT_TRUE(logEnabled(VERBOSE_LOG_LEVEL));
+    LOG_DEBUG("progress");
+    EXPECT_EQ("progress\n", log.text());
+}
+
+TEST(Log, ListsArePrintedWithSeparators) {
+    CapturedLog log(LogLevel::Info);
+    const std::vector<int> cycle{1, 2, 3};
+    LOG_INFO("Cycle found: " << logList(cycle));
+    EXPECT_EQ("Cycle found: 1, 2, 3, \n", log.text());
+}
+
+TEST(Log, NullSinkDiscardsMessages) {
+    CapturedLog log(LogLevel::Info);
+    setLogSink(nullptr);
+    LOG_ERROR("dropped");
+    LOG_INFO("dropped too");
+    setLogSink(log.sink());
+    LOG_INFO("kept");
+    EXPECT_EQ("kept\n", log.text());
+}
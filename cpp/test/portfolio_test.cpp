@@ -0,0 +1,111 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+
+#include "../include/portfolio.h"
+
+namespace {
+
+void link(AdjList& a, const int v1, const int v2) {
+    a[v1].emplace_back(v1, v2);
+    a[v2].emplace_back(v2, v1);
+}
+
+/**
+ * Two cycles of length 6 sharing vertex 0 and a pendant edge at the other vertices
+ * of the first one.
+ */
+AdjList figureEight() {
+    AdjList a;
+    for(int i = 0; i < 6; i++) {
+        link(a, i == 0 ? 0 : i, (i + 1) % 6);
+        link(a, i == 0 ? 0 : 10 + i, i == 5 ? 0 : 11 + i);
+    }
+    for(int i = 1; i < 6; i++) {
+        link(a, i, 20 + i);
+    }
+    return a;
+}
+
+/**
+ * Complete graph on 6 vertices, which the default solver fails to color.
+ */
+AdjList completeGraphK6() {
+    AdjList a;
+    for(int v1 = 0; v1 < 6; v1++) {
+        for(int v2 = v1 + 1; v2 < 6; v2++) {
+            link(a, v1, v2);
+        }
+    }
+    return a;
+}
+
+void expectValid(Graph& outGraph, const int numEdges) {
+    EXPECT_EQ(numEdges, outGraph.numEdges());
+    for(const auto& kv : outGraph.getAdj()) {
+        EXPECT_TRUE(outGraph.isOK(kv.first)) << "vertex " << kv.first;
+    }
+}
+
+}
+
+TEST(Portfolio, SeededSolversColorValidly) {
+    for(unsigned seed = 1; seed <= 8; seed++) {
+        AdjList a = figureEight();
+        Graph g(a);
+        SolverConfig config;
+        config.reseed(seed);
+        config.reach = 2 + seed % 2;
+        g.setConfig(&config);
+        AdjList empty;
+        Graph outGraph(empty);
+        if(g.color(outGraph)) {
+            expectValid(outGraph, 17);
+        }
+    }
+}
+
+TEST(Portfolio, FirstSuccessfulInstanceWins) {
+    AdjList a = figureEight();
+    Graph g(a);
+    AdjList empty;
+    Graph outGraph(empty);
+    SolverStats stats;
+
+    ASSERT_TRUE(colorPortfolio(g, outGraph, 4, 1, &stats));
+    EXPECT_TRUE(g.isEmpty());
+    expectValid(outGraph, 17);
+    EXPECT_TRUE(stats.success);
+}
+
+TEST(Portfolio, ColorsK6WhichTheDefaultSolverFails) {
+    AdjList a = completeGraphK6();
+    Graph single(a);
+    AdjList empty;
+    Graph singleOut(empty);
+    ASSERT_FALSE(single.color(singleOut));
+
+    Graph g(a);
+    Graph outGraph(empty);
+    ASSERT_TRUE(colorPortfolio(g, outGraph, 16, 4, nullptr));
+    expectValid(outGraph, 15);
+}
+
+TEST(Portfolio, CancelledSolverFailsAndKeepsEdges) {
+    AdjList a = figureEight();
+    Graph g(a);
+    std::atomic<bool> cancelled(true);
+    SolverConfig config;
+    config.cancelled = &cancelled;
+    g.setConfig(&config);
+    AdjList empty;
+    Graph outGraph(empty);
+
+    EXPECT_FALSE(g.color(outGraph));
+    EXPECT_EQ(17, g.numEdges() + outGraph.numEdges());
+    EXPECT_GT(g.numEdges(), 0);
+}
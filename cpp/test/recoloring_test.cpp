@@ -0,0 +1,113 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include <gtest/gtest.h>
+
+#include "../include/recoloring.h"
+
+namespace {
+
+void link(AdjList& a, const int v1, const int v2, const int color) {
+    a[v1].emplace_back(v1, v2, color);
+    a[v2].emplace_back(v2, v1, color);
+}
+
+void expectColored(Graph& graph) {
+    for(const auto& kv : graph.getAdj()) {
+        EXPECT_TRUE(graph.isOK(kv.first)) << "vertex " << kv.first;
+        for(const auto& e : kv.second) {
+            EXPECT_GT(e.color, 0) << "edge " << e.v1 << "-" << e.v2;
+        }
+    }
+}
+
+}
+
+TEST(Recoloring, InsertedEdgeExtendingIntervalsIsColoredDirectly) {
+    // path 0-1-...-20 colored 1, 2, 1, 2, ...
+    AdjList a;
+    for(int v = 0; v < 20; v++) {
+        link(a, v, v + 1, 1 + v % 2);
+    }
+    Graph g(a);
+    SolverStats stats;
+    EXPECT_TRUE(recolor(g, {EdgeEdit(EdgeEdit::Insert, 20, 21)}, 1, &stats));
+    EXPECT_EQ(1, g.getEdge(20, 21).color);
+    for(int v = 0; v < 20; v++) {
+        EXPECT_EQ(1 + v % 2, g.getEdge(v, v + 1).color);
+    }
+    EXPECT_TRUE(stats.success);
+    EXPECT_EQ(22, stats.vertices);
+    EXPECT_EQ(0, stats.cyclesFound + stats.forestIterations);
+}
+
+TEST(Recoloring, GapLeftByDeletionIsRepairedNearby) {
+    // star with center 0 colored 1, 2, 3 and a far away path colored 4, 5
+    AdjList a;
+    link(a, 0, 1, 1);
+    link(a, 0, 2, 2);
+    link(a, 0, 3, 3);
+    link(a, 10, 11, 4);
+    link(a, 11, 12, 5);
+    Graph g(a);
+    EXPECT_TRUE(recolor(g, {EdgeEdit(EdgeEdit::Delete, 0, 2)}));
+    EXPECT_FALSE(g.isEdge(0, 2));
+    EXPECT_EQ(4, g.numEdges());
+    expectColored(g);
+    EXPECT_EQ(4, g.getEdge(10, 11).color);
+    EXPECT_EQ(5, g.getEdge(11, 12).color);
+}
+
+TEST(Recoloring, ClosingEvenCycleRecolorsAroundIt) {
+    // path 0-1-...-5 colored 1, 2, ..., 5: closing it needs edge 0-5 colored 2
+    // at 0 and 4 or 6 at 5, so edges next to it are colored again
+    AdjList a;
+    for(int v = 0; v < 5; v++) {
+        link(a, v, v + 1, v + 1);
+    }
+    Graph g(a);
+    std::vector<EdgeEdit> edits = {EdgeEdit(EdgeEdit::Insert, 0, 5),
+        EdgeEdit(EdgeEdit::Insert, 0, 0), EdgeEdit(EdgeEdit::Delete, 7, 8)};
+    SolverStats stats;
+    EXPECT_TRUE(recolor(g, edits, 1, &stats));
+    EXPECT_EQ(6, g.numEdges());
+    expectColored(g);
+    // the middle of the path is out of reach
+    EXPECT_EQ(3, g.getEdge(2, 3).color);
+    EXPECT_TRUE(g.getEdge(0, 1).color != 1 || g.getEdge(4, 5).color != 5);
+}
+
+TEST(Recoloring, FailsOnInfeasibleResult) {
+    AdjList a;
+    link(a, 0, 1, 1);
+    link(a, 1, 2, 2);
+    Graph g(a);
+    SolverStats stats;
+    EXPECT_FALSE(recolor(g, {EdgeEdit(EdgeEdit::Insert, 0, 2)}, 1, &stats));
+    EXPECT_EQ(3, g.numEdges());
+    EXPECT_FALSE(stats.success);
+
+    // deleting an edge of the triangle makes it colorable again
+    EXPECT_TRUE(recolor(g, {EdgeEdit(EdgeEdit::Delete, 1, 2)}));
+    EXPECT_EQ(2, g.numEdges());
+    expectColored(g);
+}
+
+TEST(Recoloring, RecolorsOutputOfSolver) {
+    // even cycle 0-...-7 colored by the solver, which leaves its colors as constraints
+    AdjList a;
+    for(int v = 0; v < 8; v++) {
+        link(a, v, (v + 1) % 8, 0);
+    }
+    Graph g(a);
+    AdjList empty;
+    Graph outGraph(empty);
+    ASSERT_TRUE(g.color(outGraph));
+    EXPECT_TRUE(recolor(outGraph, {EdgeEdit(EdgeEdit::Delete, 3, 4), EdgeEdit(EdgeEdit::Insert, 3, 8),
+        EdgeEdit(EdgeEdit::Insert, 8, 9), EdgeEdit(EdgeEdit::Insert, 9, 4)}));
+    EXPECT_EQ(10, outGraph.numEdges());
+    expectColored(outGraph);
+    EXPECT_EQ(2u, outGraph.getAllVertexConstraints(3).size());
+}
@@ -0,0 +1,295 @@
+/**
+ *  @author Michal Kostrzewa
+ *  @author Michal Zakowski
+ */
+
+#include <gtest/gtest.h>
+
+#include "../include/server.h"
+#include "../include/binary_format.h"
+#include "../include/graph.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+std::string socketPath() {
+    return "/tmp/gcolor_server_test_" + std::to_string(getpid()) + ".sock";
+}
+
+/**
+ * Send requests on a new connection, end input and return everything the server answered.
+ */
+/**
+ * Open connection to the server, reads give up after 5 seconds. Return -1 on failure.
+ */
+int connectTo(const std::string& path) {
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, path.c_str());
+    if(connect(fd, (const sockaddr*)&address, sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    const timeval timeout = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+/**
+ * Read from socket until it ends or text ends with until.
+ */
+std::string receive(const int fd, const std::string& until = std::string()) {
+    std::string received;
+    char chunk[4096];
+    ssize_t n;
+    while((until.empty() || received.size() < until.size()
+            || received.compare(received.size() - until.size(), until.size(), until) != 0)
+            && (n = read(fd, chunk, sizeof(chunk))) > 0) {
+        received.append(chunk, (size_t)n);
+    }
+    return received;
+}
+
+std::string exchange(const std::string& path, const std::string& requests) {
+    const int fd = connectTo(path);
+    if(fd == -1) {
+        return "cannot connect";
+    }
+    // answers are read while requests are still sent
+    std::thread sender([fd, &requests] {
+        size_t sent = 0;
+        while(sent < requests.size()) {
+            const ssize_t n = send(fd, requests.data() + sent, requests.size() - sent, MSG_NOSIGNAL);
+            if(n <= 0) {
+                break;
+            }
+            sent += (size_t)n;
+        }
+        shutdown(fd, SHUT_WR);
+    });
+    const std::string answers = receive(fd);
+    sender.join();
+    close(fd);
+    return answers;
+}
+
+/**
+ * Answer split into its status line and edge lines.
+ */
+struct Answer {
+    std::string status;
+    std::vector<Edge> edges;
+};
+
+std::vector<Answer> parse(const std::string& answers) {
+    std::vector<Answer> result;
+    std::istringstream in(answers);
+    std::string line;
+    bool inAnswer = false;
+    while(std::getline(in, line)) {
+        if(line.empty()) {
+            inAnswer = false;
+        } else if(!inAnswer) {
+            result.emplace_back();
+            result.back().status = line;
+            inAnswer = true;
+        } else {
+            int v1, v2, color;
+            std::istringstream(line) >> v1 >> v2 >> color;
+            result.back().edges.emplace_back(v1, v2, color);
+        }
+    }
+    return result;
+}
+
+void expectColored(const std::vector<Edge>& edges) {
+    AdjList a;
+    for(const auto& e : edges) {
+        a[e.v1].emplace_back(e.v1, e.v2, e.color);
+        a[e.v2].emplace_back(e.v2, e.v1, e.color);
+    }
+    Graph g(a);
+    for(const auto& kv : a) {
+        EXPECT_TRUE(g.isOK(kv.first)) << "vertex " << kv.first;
+    }
+}
+
+/**
+ * Server running on its own thread for the duration of a test.
+ */
+class RunningServer {
+public:
+    explicit RunningServer(const ServerOptions& options = ServerOptions())
+        : server(options) {
+        listening = server.listen(socketPath());
+        thread = std::thread([this] { server.run(); });
+    }
+    ~RunningServer() {
+        server.stop();
+        thread.join();
+    }
+    Server server;
+    bool listening;
+    std::thread thread;
+};
+
+}
+
+TEST(Server, AnswersPipelinedRequestsInOrder) {
+    // binary request holding an even cycle
+    AdjList a;
+    for(int v = 0; v < 6; v++) {
+        a[v].emplace_back(v, (v + 1) % 6);
+        a[(v + 1) % 6].emplace_back((v + 1) % 6, v);
+    }
+    const std::string binaryFile = socketPath() + ".gcb";
+    ASSERT_TRUE(Graph(a).serializeBinary(binaryFile));
+    std::ifstream file(binaryFile, std::ios::binary);
+    const std::string binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::remove(binaryFile.c_str());
+
+    RunningServer running;
+    ASSERT_TRUE(running.listening);
+    const std::string answers = exchange(socketPath(),
+        "1 2 4\n2 3\n3 4\n\n"
+        "\n1 2 3\n2 3\n\n"
+        "binary " + std::to_string(binary.size()) + "\n" + binary +
+        "7 8");
+    const auto parsed = parse(answers);
+    ASSERT_EQ(4u, parsed.size()) << answers;
+    EXPECT_EQ("ok 4", parsed[0].status);
+    expectColored(parsed[0].edges);
+    EXPECT_EQ("failed 3", parsed[1].status);
+    EXPECT_EQ("ok 6", parsed[2].status);
+    expectColored(parsed[2].edges);
+    EXPECT_EQ("ok 1", parsed[3].status);
+    ASSERT_EQ(1u, parsed[3].edges.size());
+    EXPECT_EQ(7, parsed[3].edges[0].v1);
+    EXPECT_EQ(8, parsed[3].edges[0].v2);
+}
+
+TEST(Server, SmallQueueAnswersEveryRequest) {
+    ServerOptions options;
+    options.maxQueued = 2;
+    RunningServer running(options);
+    ASSERT_TRUE(running.listening);
+    // stars with 1 to 5 edges
+    std::string requests;
+    for(int i = 0; i < 200; i++) {
+        requests += "0";
+        for(int leaf = 1; leaf <= 1 + i % 5; leaf++) {
+            requests += " " + std::to_string(leaf);
+        }
+        requests += "\n\n";
+    }
+    const auto parsed = parse(exchange(socketPath(), requests));
+    ASSERT_EQ(200u, parsed.size());
+    for(int i = 0; i < 200; i++) {
+        EXPECT_EQ("ok " + std::to_string(1 + i % 5), parsed[i].status);
+    }
+}
+
+TEST(Server, MalformedRequestEndsConnection) {
+    RunningServer running;
+    ASSERT_TRUE(running.listening);
+    const auto parsed = parse(exchange(socketPath(), "1 2\n\nbinary x\n1 2\n\n"));
+    ASSERT_EQ(2u, parsed.size());
+    EXPECT_EQ("ok 1", parsed[0].status);
+    EXPECT_EQ("error invalid length of binary request", parsed[1].status);
+
+    // other connections are served
+    EXPECT_EQ("ok 1", parse(exchange(socketPath(), "1 2\n"))[0].status);
+    EXPECT_EQ("error incomplete binary request",
+        parse(exchange(socketPath(), "binary 100\n1 2\n"))[0].status);
+}
+
+TEST(Server, CorruptedBinaryRequestGetsError) {
+    AdjList a;
+    a[1] = {Edge(1, 2), Edge(1, 3)};
+    const std::string binaryFile = socketPath() + ".gcb";
+    ASSERT_TRUE(Graph(a).serializeBinary(binaryFile));
+    std::ifstream file(binaryFile, std::ios::binary);
+    std::string binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::remove(binaryFile.c_str());
+    // every vertex gets id 1
+    const size_t idsAt = sizeof(BinaryGraphHeader);
+    for(size_t v = 1; v < 3; v++) {
+        std::memcpy(&binary[idsAt + 4 * v], &binary[idsAt], 4);
+    }
+
+    RunningServer running;
+    ASSERT_TRUE(running.listening);
+    const auto parsed = parse(exchange(socketPath(),
+        "binary " + std::to_string(binary.size()) + "\n" + binary + "1 2\n"));
+    ASSERT_EQ(2u, parsed.size());
+    EXPECT_EQ("error invalid binary graph", parsed[0].status);
+    EXPECT_EQ("ok 1", parsed[1].status);
+}
+
+TEST(Server, ClientNotReadingAnswersStallsNoOtherClient) {
+    ServerOptions options;
+    options.maxQueued = 8;
+    RunningServer running(options);
+    ASSERT_TRUE(running.listening);
+    // even cycles whose answers fill the socket of a client that never reads them
+    std::string cycle;
+    for(int v = 0; v < 1000; v++) {
+        cycle += std::to_string(v) + " " + std::to_string((v + 1) % 1000) + "\n";
+    }
+    cycle += "\n";
+    const int stalled = connectTo(socketPath());
+    ASSERT_NE(-1, stalled);
+    std::atomic<int> sent(0);
+    std::thread sender([stalled, &cycle, &sent] {
+        for(int i = 0; i < 100; i++) {
+            if(send(stalled, cycle.data(), cycle.size(), MSG_NOSIGNAL) <= 0) {
+                break;
+            }
+            sent++;
+        }
+    });
+    // until everything is sent or the server stops reading it
+    int last;
+    do {
+        last = sent;
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    } while(sent != last);
+
+    const auto parsed = parse(exchange(socketPath(), "1 2\n"));
+    shutdown(stalled, SHUT_RDWR);
+    sender.join();
+    close(stalled);
+    ASSERT_EQ(1u, parsed.size());
+    EXPECT_EQ("ok 1", parsed[0].status);
+}
+
+TEST(Server, StopDropsRequestReceivedInPart) {
+    RunningServer running;
+    ASSERT_TRUE(running.listening);
+    const int fd = connectTo(socketPath());
+    ASSERT_NE(-1, fd);
+    const std::string requests = "1 2\n\n3 4";
+    ASSERT_EQ((ssize_t)requests.size(), send(fd, requests.data(), requests.size(), MSG_NOSIGNAL));
+    std::string answers = receive(fd, "\n\n");
+    running.server.stop();
+    answers += receive(fd);
+    close(fd);
+    const auto parsed = parse(answers);
+    ASSERT_EQ(1u, parsed.size());
+    EXPECT_EQ("ok 1", parsed[0].status);
+}
@@ -453,6 +453,30 @@ TEST(Backtracking, ZeroingColorsAlongPathWorks) {
     EXPECT_EQ(0, g.getEdge(3, 4).color);
 }
 
+TEST(Backtracking, PathEdgesStayValidWhenGraphGrows) {
+    auto g = generateSimpleLoopGraphWith10Vertices();
+    auto edges = g.pathEdges(std::vector<int>{3, 2, 1});
+    for(int i = 0; i < 100; i++) {
+        g.addEdge(Edge(1, 100 + i));
+    }
+    g.colorEdge(2, 1, 5);
+    EXPECT_TRUE(edges[1].isValid());
+    EXPECT_EQ(2, edges[1]->v1);
+    EXPECT_EQ(1, edges[1]->v2);
+    EXPECT_EQ(5, edges[1]->color);
+    EXPECT_EQ(3, edges[0].v1());
+}
+
+TEST(Backtracking, HandleOfMovedEdgeIsInvalid) {
+    auto g = generateSimpleLoopGraphWith10Vertices();
+    auto outG = generateEmptyGraph();
+    auto edges = g.pathEdges(std::vector<int>{4, 5, 6});
+    g.moveEdgeToAnotherGraph(outG, edges[0]);
+    EXPECT_FALSE(edges[0].isValid());
+    EXPECT_TRUE(edges[1].isValid());
+    EXPECT_TRUE(outG.isEdge(4, 5));
+}
+
 TEST(Backtracking, LoopWithNoConstraintsWorks) {
     auto g = generateSimpleLoopGraphWith10Vertices();
 
@@ -547,6 +571,38 @@ TEST(Backtracking, LoopTriangleDoesNotGetColoredAndReturnsFalse) {
             << "Current vertex: " << 10;
 }
 
+TEST(Backtracking, PathLeavingTooWideGapIsRejectedWithoutDescending) {
+    auto g = generateSimpleLoopGraphWith10Vertices();
+    // two path edges cannot fill 2, 3 and 4
+    g.addVertexConstraint(2, 1);
+    g.addVertexConstraint(2, 5);
+    SolverStats stats;
+    g.setStats(&stats);
+    const std::vector<int> indicesInPath{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+
+    EXPECT_FALSE(g.colorPath(g.pathEdges(indicesInPath)));
+    EXPECT_LE(stats.backtrackNodes, 2);
+    for(unsigned i = 1; i <= 9; i++) {
+        EXPECT_EQ(0, g.getEdge(i, i+1).color) << "Current vertex: " << i;
+    }
+}
+
+TEST(Backtracking, FailedBacktrackingRestoresPreviousColors) {
+    auto g = generateSimpleLoopGraphWith10Vertices();
+    g.addEdge(Edge(3, 1, 0));
+    g.colorEdge(1, 2, 4);
+    SolverStats stats;
+    g.setStats(&stats);
+    const std::vector<int> indicesInPath{1, 2, 3, 1};
+
+    EXPECT_FALSE(g.colorPath(g.pathEdges(indicesInPath)));
+    EXPECT_EQ(4, g.getEdge(1, 2).color);
+    EXPECT_EQ(0, g.getEdge(2, 3).color);
+    EXPECT_EQ(0, g.getEdge(3, 1).color);
+    EXPECT_EQ(4, g.getHighestColor(2));
+    EXPECT_GT(stats.backtrackUndone, 0);
+}
+
 TEST(Cycle, FindingCycleInLoopGraphWorks) {
     auto g = generateSimpleLoopGraphWith10Vertices();
     const auto& cycle = g.findCycle();
@@ -567,7 +623,7 @@ TEST(Cycle, FindingCycleInTreeReturnsEmpty) {
 TEST(Forest, ColoringATreeWithSingleEdgeWorks) {
     auto g = generateEmptyGraph();
     g.addEdge(Edge(1, 2, 0));
-    g.colorAsForest();
+    EXPECT_TRUE(g.colorAsForest());
     for(const auto& v : g.getAdj()) {
         for(const auto& e : v.second) {
             EXPECT_NE(0, e.color);
@@ -577,6 +633,15 @@ TEST(Forest, ColoringATreeWithSingleEdgeWorks) {
     }
 }
 
+TEST(Forest, ColoringAnImpossibleTreeFailsAndKeepsItsEdges) {
+    auto g = generateEmptyGraph();
+    g.addEdge(Edge(1, 2, 0));
+    g.addVertexConstraint(1, 1);
+    g.addVertexConstraint(2, 5);
+    EXPECT_FALSE(g.colorAsForest());
+    EXPECT_EQ(1, g.numEdges());
+}
+
 TEST(Forest, ColoringATreeWorks) {
     auto g = generateSimpleTreeGraph();
     g.colorAsForest();
@@ -858,6 +923,38 @@ TEST(Coloring, ColoringACompleteGraphK4Works) {
     EXPECT_EQ(verticesBefore, outG.getAdj().size());
 }
 
+TEST(Coloring, ColoringATriangleFailsInsteadOfRequeuingForever) {
+    auto g = generateTriangleGraph();
+    auto outG = generateEmptyGraph();
+    SolverStats stats;
+    g.setStats(&stats);
+    EXPECT_FALSE(g.color(outG));
+    EXPECT_EQ(3, g.numEdges() + outG.numEdges());
+    EXPECT_LE(stats.queuePushes, 3);
+}
+
+TEST(Coloring, ColoringStopsRetryingOnlyAfterEveryQueuedFragmentFailedAgain) {
+    AdjList a;
+    const std::vector<std::pair<int, int> > edges{{1, 2}, {2, 3}, {3, 1},
+        {4, 5}, {5, 6}, {6, 7}, {7, 4}};
+    for(const auto& e : edges) {
+        a[e.first].emplace_back(e.first, e.second);
+        a[e.second].emplace_back(e.second, e.first);
+    }
+    Graph g(a);
+    auto outG = generateEmptyGraph();
+    SolverStats stats;
+    g.setStats(&stats);
+    EXPECT_FALSE(g.color(outG));
+    // the triangle is given back, the square is colored in spite of it
+    EXPECT_EQ(3, g.numEdges());
+    EXPECT_EQ(4, outG.numEdges());
+    for(int v = 4; v <= 7; v++) {
+        EXPECT_TRUE(outG.isOK(v));
+    }
+    EXPECT_LE(stats.queuePushes, 3);
+}
+
 TEST(Coloring, ColoringATriangleWithTwoConstraintsWorks) {
     auto g = generateTriangleGraph();
     g.addVertexConstraint(1, 10);
@@ -1002,6 +1099,214 @@ TEST(Pathfinding, GettingPathFromTreeReturnsMostContrainedPathWith1ConstraintFir
     EXPECT_EQ(8, path.front());
 }
 
+TEST(Pathfinding, ConstraintAddedBetweenCallsMovesStartOfPath) {
+    auto g = generateSimpleTreeGraph();
+    g.addVertexConstraint(8, 1);
+    EXPECT_EQ(8, g.findPath().front());
+    g.addVertexConstraint(3, 1);
+    g.addVertexConstraint(3, 2);
+    EXPECT_EQ(3, g.findPath().front());
+    auto tempG = generateEmptyGraph();
+    g.moveEdgeToAnotherGraph(tempG, 2, 3);
+    EXPECT_EQ(8, g.findPath().front());
+}
+
+TEST(Summary, SummaryFollowsRecoloringOfExtremeColors) {
+    auto g = generateSimpleLoopGraphWith10Vertices();
+    g.colorEdge(2, 1, 5);
+    g.colorEdge(2, 3, 6);
+    EXPECT_EQ(5, g.summaryOf(2).lowest);
+    EXPECT_EQ(6, g.summaryOf(2).highest);
+    g.colorEdge(2, 3, 4);
+    EXPECT_EQ(4, g.summaryOf(2).lowest);
+    EXPECT_EQ(5, g.summaryOf(2).highest);
+    g.colorEdge(2, 1, 0);
+    EXPECT_EQ(4, g.summaryOf(2).lowest);
+    EXPECT_EQ(4, g.summaryOf(2).highest);
+    EXPECT_EQ(1, g.summaryOf(2).distinct);
+}
+
+TEST(Summary, SummaryCountsConstraintsAndEdgeColorsOnce) {
+    auto g = generateSimpleLoopGraphWith10Vertices();
+    g.addVertexConstraint(3, 7);
+    g.addVertexConstraint(3, 7);
+    g.colorEdge(3, 4, 7);
+    EXPECT_EQ(1, g.summaryOf(3).distinct);
+    EXPECT_EQ(0, g.summaryOf(3).duplicates);
+    EXPECT_TRUE(g.isOK(3));
+}
+
+TEST(Summary, ClearingConstraintsKeepsEdgeColors) {
+    auto g = generateSimpleLoopGraphWith10Vertices();
+    g.colorEdge(3, 4, 7);
+    g.addVertexConstraint(3, 7);
+    g.addVertexConstraint(3, 9);
+    EXPECT_TRUE(g.areGaps(3));
+    g.clearVertexConstraints();
+    EXPECT_FALSE(g.areGaps(3));
+    EXPECT_EQ(1, g.summaryOf(3).distinct);
+    EXPECT_EQ(7, g.summaryOf(3).highest);
+    EXPECT_EQ(std::vector<int>{7}, g.getAllVertexConstraints(3));
+}
+
+TEST(Summary, TwoEdgesWithTheSameColorAreDetected) {
+    auto g = generateSimpleLoopGraphWith10Vertices();
+    g.colorEdge(5, 4, 3);
+    g.colorEdge(5, 6, 3);
+    EXPECT_EQ(1, g.summaryOf(5).duplicates);
+    EXPECT_FALSE(g.isOK(5));
+    g.colorEdge(5, 6, 4);
+    EXPECT_EQ(0, g.summaryOf(5).duplicates);
+    EXPECT_TRUE(g.isOK(5));
+}
+
+TEST(Summary, MovingEdgeAwayRemovesItsColorFromSummary) {
+    auto g = generateSimpleLoopGraphWith10Vertices();
+    auto outG = generateEmptyGraph();
+    g.colorEdge(7, 8, 2);
+    g.colorEdge(7, 6, 4);
+    EXPECT_TRUE(g.areGaps(7));
+    g.moveEdgeToAnotherGraph(outG, 7, 6);
+    EXPECT_FALSE(g.areGaps(7));
+    EXPECT_EQ(2, g.summaryOf(7).highest);
+    EXPECT_EQ(4, outG.summaryOf(6).lowest);
+}
+
+TEST(Stats, ColoringLoopCountsCycleAndBacktracking) {
+    auto g = generateSimpleLoopGraphWith10Vertices();
+    auto outG = generateEmptyGraph();
+    SolverStats stats;
+    g.setStats(&stats);
+    const bool success = g.color(outG);
+    EXPECT_EQ(success, stats.success);
+    EXPECT_EQ(10, stats.vertices);
+    EXPECT_EQ(10, stats.edges);
+    EXPECT_EQ(1, stats.cyclesFound);
+    EXPECT_EQ(0, stats.hangingEdgesPeeled);
+    EXPECT_GE(stats.backtrackNodes, 11);
+    EXPECT_GE(stats.totalTime, stats.pathColoringTime + stats.cycleSearchTime);
+}
+
+TEST(Stats, JsonContainsCountersAndPhases) {
+    SolverStats stats;
+    stats.cyclesFound = 3;
+    stats.success = true;
+    const std::string json = stats.toJson();
+    EXPECT_NE(std::string::npos, json.find("\"cycles_found\": 3,"));
+    EXPECT_NE(std::string::npos, json.find("\"success\": true"));
+    EXPECT_NE(std::string::npos, json.find("\"phases_seconds\""));
+}
+
+TEST(Cycle, FindingVeryLongCycleWorks) {
+    const int n = 300000;
+    AdjList a;
+    for(int v = 0; v < n; v++) {
+        a[v] = {Edge(v, (v + 1) % n), Edge(v, (v + n - 1) % n)};
+    }
+    Graph g(a);
+    const auto cycle = g.findCycle();
+    ASSERT_EQ(n + 1, (int)cycle.size());
+    EXPECT_EQ(0, cycle.front());
+    EXPECT_EQ(0, cycle.back());
+    EXPECT_EQ(1, cycle[1]);
+}
+
+TEST(Backtracking, ColoringVeryLongPathWorks) {
+    const int n = 300000;
+    AdjList a;
+    for(int v = 0; v < n; v++) {
+        if(v > 0) {
+            a[v].emplace_back(v, v - 1);
+        }
+        if(v + 1 < n) {
+            a[v].emplace_back(v, v + 1);
+        }
+    }
+    Graph g(a);
+    const auto path = g.findPath();
+    ASSERT_EQ(n, (int)path.size());
+    EXPECT_TRUE(g.colorPath(g.pathEdges(path)));
+    for(int v = 0; v < n; v++) {
+        EXPECT_TRUE(g.isOK(v));
+    }
+}
+
+TEST(Backtracking, ColoringVeryLongCycleByDynamicProgrammingWorks) {
+    const int n = 300000;
+    AdjList a;
+    for(int v = 0; v < n; v++) {
+        a[v] = {Edge(v, (v + 1) % n), Edge(v, (v + n - 1) % n)};
+    }
+    Graph g(a);
+    g.addVertexConstraint(0, 1);
+    g.addVertexConstraint(0, 2);
+    const auto cycle = g.findCycle();
+    ASSERT_EQ(n + 1, (int)cycle.size());
+    EXPECT_TRUE(g.colorPathDP(g.pathEdges(cycle)));
+    for(int v = 0; v < n; v++) {
+        EXPECT_TRUE(g.isOK(v)) << "vertex " << v;
+    }
+}
+
+TEST(Backtracking, DynamicProgrammingRejectsOddCycleAndPathWithoutColoring) {
+    auto g = generateSimpleLoopGraphWith10Vertices();
+    g.addEdge(Edge(3, 1, 0));
+    EXPECT_FALSE(g.colorPathDP(g.pathEdges({1, 2, 3, 1})));
+    EXPECT_EQ(0, g.getEdge(1, 2).color);
+    EXPECT_EQ(0, g.getEdge(3, 1).color);
+
+    // vertex 2 has a gap of three colors and only two path edges
+    auto h = generateSimpleLoopGraphWith10Vertices();
+    h.addVertexConstraint(2, 1);
+    h.addVertexConstraint(2, 5);
+    EXPECT_FALSE(h.colorPathDP(h.pathEdges({1, 2, 3, 4})));
+}
+
+TEST(Backtracking, DynamicProgrammingColorsPathBetweenConstraints) {
+    auto g = generateSimpleLoopGraphWith10Vertices();
+    g.addVertexConstraint(1, 2);
+    g.addVertexConstraint(6, 7);
+    const std::vector<int> path{1, 2, 3, 4, 5, 6};
+    EXPECT_TRUE(g.colorPathDP(g.pathEdges(path)));
+    for(const int v : {1, 2, 3, 4, 5}) {
+        EXPECT_TRUE(g.isOK(v)) << "vertex " << v;
+    }
+    const int last = g.getEdge(5, 6).color;
+    EXPECT_TRUE(last >= 5 && last <= 9 && last != 7);
+}
+
+TEST(Hanging, PeelOrderStartsAtLeavesAndEndsAtTheLoop) {
+    auto g = generateGraphWithOneLoopAndSomeHangingEges();
+    auto outG = generateEmptyGraph();
+    g.moveHangingEdgesTo(outG);
+    const auto& order = outG.getPeelOrder();
+    ASSERT_EQ(outG.numEdges(), (int)order.size());
+    // every hanging vertex is peeled before its neighbour
+    std::set<int> peeled;
+    for(const auto& edge : order) {
+        EXPECT_EQ(0u, peeled.count(edge.second));
+        peeled.insert(edge.first);
+    }
+    for(const auto& edge : order) {
+        EXPECT_FALSE(g.isEdge(edge.first, edge.second));
+    }
+}
+
+TEST(Hanging, PeelingVeryLongPathMovesAllEdges) {
+    const int n = 300000;
+    AdjList a;
+    for(int v = 0; v + 1 < n; v++) {
+        a[v].emplace_back(v, v + 1);
+        a[v + 1].emplace_back(v + 1, v);
+    }
+    Graph g(a);
+    auto outG = generateEmptyGraph();
+    EXPECT_TRUE(g.moveHangingEdgesTo(outG));
+    EXPECT_TRUE(g.isEmpty());
+    EXPECT_EQ(n - 1, outG.numEdges());
+    EXPECT_EQ(n - 1, (int)outG.getPeelOrder().size());
+}
+
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();